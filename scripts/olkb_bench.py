@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""
+Host micro-benchmarks for a keymap generated by oryx_to_olkb.py.
+
+Builds the generated keymap.c/keymap_layers.c with olkb_hooks.c against the
+QMK stubs and host shim in scripts/qmk_stubs/, then times the keymap's hot
+paths in tight loops: dance_step, every tap dance's finished + reset
+callbacks, process_record_user for each layer's keys and the layered keycode
+lookup. Cycles and instructions per call come from Linux hardware counters
+when perf_event_open is allowed, wall time per call always.
+
+Results are JSON tagged with the converter revision and a hash of the
+generated sources; pass an earlier result with --baseline to compare.
+The converter's optional firmware modules are left out of the build, so
+the numbers describe the code generated from the Oryx export.
+"""
+import argparse
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from oryx_to_olkb import (FEATURE_MODULES, MODULES_DIR, OUTPUT_DIR, STUBS_DIR,
+                          stub_compile_flags, write_preflight_keycodes)
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+DEFAULT_ITERATIONS = 2000000
+DEFAULT_CFLAGS = "-O2"
+
+# dance_step() results Oryx exports distinguish: (name, count, pressed, interrupted)
+DANCE_STEP_VARIANTS = [
+    ("single_tap", 1, 0, 0),
+    ("single_hold", 1, 1, 0),
+    ("double_tap", 2, 0, 0),
+    ("double_hold", 2, 1, 0),
+    ("double_single_tap", 2, 0, 1),
+    ("more_taps", 3, 0, 0),
+]
+
+# Finished + reset per dance for the outcomes most dances define
+DANCE_VARIANTS = [
+    ("tap", 1, 0, 0),
+    ("hold", 1, 1, 0),
+    ("double_tap", 2, 0, 0),
+]
+
+DANCE_STEP_RE = re.compile(r"^uint8_t\s+(dance_step\w*)\s*\(\s*tap_dance_state_t\s*\*\s*\w+\s*\)\s*\{", re.MULTILINE)
+
+BENCH_CASES_TEMPLATE = """// Generated by olkb_bench.py: benchmark cases for the converted keymap
+#include "keymap.c"
+#include "keymap_layers.c"
+#include "bench.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEYMAP_KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define DANCE_COUNT (sizeof(tap_dance_actions) / sizeof(tap_dance_actions[0]))
+
+volatile uint16_t bench_sink;
+
+uint8_t keymap_layer_count(void) {{
+    return sizeof(keymaps) / sizeof(keymaps[0]);
+}}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {{
+    return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}}
+
+static keypos_t key_at(uint8_t index) {{
+    return (keypos_t){{.row = index / MATRIX_COLS, .col = index % MATRIX_COLS}};
+}}
+
+/* Keycode lookup: one key per call, walking the whole matrix */
+static void run_lookup(void *arg) {{
+    static uint8_t index;
+    layer_state   = *(layer_state_t *)arg;
+    keypos_t key  = key_at(index);
+    bench_sink    = keymap_key_to_keycode(layer_switch_get_layer(key), key);
+    index         = (index + 1) % KEYMAP_KEYS;
+}}
+
+/* process_record_user: one press and release per call, walking one layer's keys */
+static void run_process_record(void *arg) {{
+    static uint8_t index;
+    uint8_t        layer   = *(uint8_t *)arg;
+    keypos_t       key     = key_at(index);
+    uint16_t       keycode = keymap_key_to_keycode(layer, key);
+    keyrecord_t    record  = {{.event = {{.key = key, .pressed = true, .type = 1}}}};
+    layer_state            = (layer_state_t)1 << layer;
+    process_record_user(keycode, &record);
+    record.event.pressed = false;
+    process_record_user(keycode, &record);
+    index = (index + 1) % KEYMAP_KEYS;
+}}
+
+typedef struct {{
+    uint16_t          index;
+    tap_dance_state_t state;
+}} dance_case_t;
+
+/* A resolved dance: the finished callback, then reset */
+static void run_dance(void *arg) {{
+    dance_case_t       *bench  = arg;
+    tap_dance_action_t *action = &tap_dance_actions[bench->index];
+    if (action->fn.on_dance_finished) {{
+        action->fn.on_dance_finished(&bench->state, action->user_data);
+    }}
+    if (action->fn.on_reset) {{
+        action->fn.on_reset(&bench->state, action->user_data);
+    }}
+}}
+
+static tap_dance_state_t dance_state_for(uint8_t count, bool pressed, bool interrupted) {{
+    tap_dance_state_t state = {{.count = count}};
+    state.pressed           = pressed;
+    state.interrupted       = interrupted;
+    state.finished          = true;
+    return state;
+}}
+
+{dance_step_runners}
+static const char *case_name(const char *format, ...) {{
+    char   *name = malloc(64);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(name, 64, format, args);
+    va_end(args);
+    return name;
+}}
+
+void bench_cases_init(void) {{
+    static layer_state_t base_layers, all_layers;
+    static uint8_t       layers[MAX_LAYER];
+    static const struct {{
+        const char *name;
+        uint8_t     count, pressed, interrupted;
+    }} variants[] = {{{dance_variants}}};
+    static tap_dance_state_t step_states[] = {{{dance_step_states}}};
+    static const char *step_names[] = {{{dance_step_names}}};
+    static dance_case_t dances[DANCE_COUNT][sizeof(variants) / sizeof(variants[0])];
+
+    default_layer_state = 1;
+    base_layers         = 0;
+    all_layers          = (layer_state_t)((1ULL << keymap_layer_count()) - 1);
+    bench_add("keycode_lookup/base_layer", run_lookup, &base_layers);
+    bench_add("keycode_lookup/all_layers_on", run_lookup, &all_layers);
+
+    for (uint8_t layer = 0; layer < keymap_layer_count(); layer++) {{
+        layers[layer] = layer;
+        bench_add(case_name("process_record_user/layer_%u", layer), run_process_record, &layers[layer]);
+    }}
+
+{dance_step_registrations}
+    for (unsigned index = 0; index < DANCE_COUNT; index++) {{
+        for (unsigned v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {{
+            dance_case_t *bench = &dances[index][v];
+            bench->index        = index;
+            bench->state        = dance_state_for(variants[v].count, variants[v].pressed, variants[v].interrupted);
+            bench_add(case_name("dance_%u/%s", index, variants[v].name), run_dance, bench);
+        }}
+    }}
+}}
+"""
+
+
+def generate_bench_cases(keymap_source):
+    """C source of the benchmark cases for this keymap's dance_step functions."""
+    steps = DANCE_STEP_RE.findall(keymap_source)
+    runners = "".join(
+        f"static void run_{name}(void *arg) {{\n    bench_sink = {name}((tap_dance_state_t *)arg);\n}}\n\n"
+        for name in steps)
+    registrations = ""
+    for name in steps:
+        registrations += (
+            f"    for (unsigned v = 0; v < {len(DANCE_STEP_VARIANTS)}; v++) {{\n"
+            f"        bench_add(case_name(\"{name}/%s\", step_names[v]), run_{name}, &step_states[v]);\n"
+            f"    }}\n")
+    return BENCH_CASES_TEMPLATE.format(
+        dance_step_runners=runners,
+        dance_step_registrations=registrations,
+        dance_variants=", ".join(f'{{"{n}", {c}, {p}, {i}}}' for n, c, p, i in DANCE_VARIANTS),
+        dance_step_states=", ".join(
+            f"{{.count = {c}, .pressed = {p}, .interrupted = {i}}}" for _, c, p, i in DANCE_STEP_VARIANTS),
+        dance_step_names=", ".join(f'"{n}"' for n, _, _, _ in DANCE_STEP_VARIANTS))
+
+
+def source_fingerprint(firmware_dir):
+    digest = hashlib.sha256()
+    for name in ("keymap.c", "keymap_layers.c", "keymap_layers.h", "config.h"):
+        with open(os.path.join(firmware_dir, name), "rb") as f:
+            digest.update(f.read())
+    return digest.hexdigest()[:16]
+
+
+def converter_revision():
+    try:
+        result = subprocess.run(["git", "-C", SCRIPT_DIR, "describe", "--always", "--dirty"],
+                                capture_output=True, text=True, check=True)
+        return result.stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def build(compiler, firmware_dir, cflags, scratch):
+    """Compile the benchmark binary; returns its path or exits with the compiler's errors."""
+    keycodes_header = os.path.join(scratch, "preflight_keycodes.h")
+    write_preflight_keycodes(firmware_dir, keycodes_header)
+    with open(os.path.join(firmware_dir, "keymap.c"), "r", encoding="utf-8") as f:
+        cases_source = generate_bench_cases(f.read())
+    cases_path = os.path.join(scratch, "bench_cases.c")
+    with open(cases_path, "w", encoding="utf-8") as f:
+        f.write(cases_source)
+
+    # Module flags stay off: their sources need the MCU, not the host shim
+    module_flags = {flag for flag, _, _, _ in FEATURE_MODULES}
+    flags = [flag for flag in stub_compile_flags(firmware_dir, os.path.join(firmware_dir, "rules.mk"), keycodes_header)
+             if not (flag.startswith("-D") and flag[2:] in module_flags)]
+    binary = os.path.join(scratch, "olkb_bench")
+    command = [compiler, *cflags.split(), "-w", *flags, "-o", binary, cases_path,
+               os.path.join(MODULES_DIR, "olkb_hooks.c"),
+               os.path.join(STUBS_DIR, "host_shim.c"), os.path.join(STUBS_DIR, "bench_main.c")]
+    result = subprocess.run(command, capture_output=True, text=True)
+    if result.returncode != 0:
+        print("Error: benchmark build failed:")
+        print(result.stderr.rstrip())
+        sys.exit(1)
+    return binary
+
+
+def run(binary, iterations):
+    result = subprocess.run([binary, str(iterations)], capture_output=True, text=True, check=True)
+    lines = result.stdout.splitlines()
+    counters = lines[0].split("\t")[1]
+    cases = []
+    for line in lines[1:]:
+        name, calls, ns, cycles, instructions = line.split("\t")
+        case = {"name": name, "calls": int(calls), "ns": float(ns)}
+        if counters == "perf":
+            case["cycles"] = float(cycles)
+            case["instructions"] = float(instructions)
+        cases.append(case)
+    return counters, cases
+
+
+def compare(results, baseline):
+    """Print per-case change against an earlier result, by cycles when both have them."""
+    metric = "cycles" if results["counters"] == baseline.get("counters") == "perf" else "ns"
+    before = {case["name"]: case for case in baseline["results"]}
+    print(f"Change in {metric} per call vs {baseline.get('converter', '?')} ({baseline.get('keymap', '?')}):",
+          file=sys.stderr)
+    for case in results["results"]:
+        old = before.get(case["name"])
+        if old is None or not old.get(metric):
+            print(f" {case['name']:<40} {case[metric]:10.2f}  (new)", file=sys.stderr)
+            continue
+        change = (case[metric] - old[metric]) / old[metric] * 100
+        print(f" {case['name']:<40} {old[metric]:10.2f} -> {case[metric]:10.2f}  {change:+6.1f}%", file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Micro-benchmark the hot paths of a converted keymap on the host.")
+    parser.add_argument("--firmware", default=OUTPUT_DIR, help=f"generated keymap folder (default: {OUTPUT_DIR})")
+    parser.add_argument("--iterations", type=int, default=DEFAULT_ITERATIONS, help="calls timed per case")
+    parser.add_argument("--cflags", default=DEFAULT_CFLAGS, help=f"host compiler flags (default: {DEFAULT_CFLAGS})")
+    parser.add_argument("--output", help="write the JSON results here instead of stdout")
+    parser.add_argument("--baseline", help="earlier JSON results to compare against")
+    args = parser.parse_args()
+
+    compiler = shutil.which(os.environ.get("CC", "cc"))
+    if compiler is None:
+        print("Error: no host C compiler found (set CC).")
+        sys.exit(1)
+    if not os.path.exists(os.path.join(args.firmware, "keymap.c")):
+        print(f"Error: no keymap.c in '{args.firmware}'. Run oryx_to_olkb.py first.")
+        sys.exit(1)
+    with tempfile.TemporaryDirectory() as scratch:
+        binary = build(compiler, args.firmware, args.cflags, scratch)
+        counters, cases = run(binary, args.iterations)
+
+    version = subprocess.run([compiler, "--version"], capture_output=True, text=True).stdout.splitlines()
+    results = {
+        "converter": converter_revision(),
+        "keymap": source_fingerprint(args.firmware),
+        "compiler": version[0] if version else compiler,
+        "cflags": args.cflags,
+        "counters": counters,
+        "iterations": args.iterations,
+        "results": cases,
+    }
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+        print(f"Wrote {len(cases)} results to {args.output} ({counters} counters)", file=sys.stderr)
+    else:
+        print(text)
+
+    if args.baseline:
+        with open(args.baseline, "r", encoding="utf-8") as f:
+            compare(results, json.load(f))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""
+Raw HID client for Planck Rev6 firmware built by oryx_to_olkb.py.
+
+Reads and writes the dynamic keymap with several requests in flight instead
+of one USB round trip per chunk. Readback pipelines VIA's
+dynamic_keymap_get_buffer (works on any VIA/Vial firmware). Upload uses the
+firmware's bulk keymap command (BULK_KEYMAP_ENABLE) when it is built in, and
+pipelined dynamic_keymap_set_buffer otherwise.
+
+Requires the hidapi bindings: pip install hidapi
+"""
+import argparse
+import sys
+import time
+from collections import deque
+
+try:
+    import hid
+except ImportError:
+    hid = None
+
+# Planck Rev6 USB IDs and the VIA/Vial raw HID interface
+VENDOR_ID = 0x03A8
+PRODUCT_ID = 0xA4F9
+USAGE_PAGE = 0xFF60
+USAGE = 0x61
+
+REPORT_SIZE = 32
+TIMEOUT_MS = 500
+MATRIX_ROWS = 8
+MATRIX_COLS = 6
+
+# VIA protocol commands
+VIA_GET_LAYER_COUNT = 0x11
+VIA_GET_BUFFER = 0x12
+VIA_SET_BUFFER = 0x13
+VIA_CHUNK = REPORT_SIZE - 4
+
+# olkb_hid.h subcommands under OLKB_HID_COMMAND
+OLKB_HID_COMMAND = 0xB0
+OLKB_HID_UNHANDLED = 0xFF
+OLKB_HID_BULK_BEGIN = 0x03
+OLKB_HID_BULK_DATA = 0x04
+OLKB_HID_BULK_END = 0x05
+BULK_CHUNK = REPORT_SIZE - 3
+BULK_STATUS = {0x00: "ok", 0x01: "Vial is locked", 0x02: "range out of bounds",
+               0x03: "sequence error", 0x04: "no transfer open"}
+
+# Outstanding requests; the firmware's IN endpoint queue holds a few replies
+DEFAULT_WINDOW = 4
+
+
+def crc16_ccitt(data, value=0xFFFF):
+    """CRC-16/CCITT-FALSE, matching crc16_ccitt() in bulk_keymap.c."""
+    for byte in data:
+        value ^= byte << 8
+        for _ in range(8):
+            value = ((value << 1) ^ 0x1021) if value & 0x8000 else value << 1
+            value &= 0xFFFF
+    return value
+
+
+class OlkbHid:
+    def __init__(self, device):
+        self.device = device
+
+    @classmethod
+    def open(cls):
+        if hid is None:
+            print("Error: the hidapi module is missing (pip install hidapi).")
+            sys.exit(1)
+        for info in hid.enumerate(VENDOR_ID, PRODUCT_ID):
+            if info["usage_page"] == USAGE_PAGE and info["usage"] == USAGE:
+                device = hid.device()
+                device.open_path(info["path"])
+                return cls(device)
+        print("Error: Planck Rev6 raw HID interface not found.")
+        sys.exit(1)
+
+    def send(self, payload):
+        report = bytes(payload) + bytes(REPORT_SIZE - len(payload))
+        # hidapi wants the report ID (0, unnumbered) in front
+        self.device.write(b"\x00" + report)
+
+    def receive(self):
+        data = bytes(self.device.read(REPORT_SIZE, TIMEOUT_MS))
+        if len(data) != REPORT_SIZE:
+            raise IOError("raw HID read timed out")
+        return data
+
+    def transact(self, payload):
+        self.send(payload)
+        return self.receive()
+
+    def pipeline(self, requests, window=DEFAULT_WINDOW):
+        """
+        Send requests keeping up to `window` in flight and return the replies
+        in order. Each reply must echo its request's header (command, offset,
+        size), which catches dropped or reordered reports.
+        """
+        replies = []
+        pending = deque()
+        for request in requests:
+            if len(pending) >= window:
+                replies.append(self._verified_reply(pending.popleft()))
+            self.send(request)
+            pending.append(request)
+        while pending:
+            replies.append(self._verified_reply(pending.popleft()))
+        return replies
+
+    def _verified_reply(self, request):
+        reply = self.receive()
+        if reply[:4] != bytes(request[:4]):
+            raise IOError(f"out-of-order reply: sent {bytes(request[:4]).hex()}, got {reply[:4].hex()}")
+        return reply
+
+    def keymap_size(self):
+        layers = self.transact([VIA_GET_LAYER_COUNT])[1]
+        return layers * MATRIX_ROWS * MATRIX_COLS * 2
+
+    def read_keymap(self, window=DEFAULT_WINDOW):
+        """Whole dynamic keymap; window=1 is the stop-and-wait Vial GUI behaviour."""
+        size = self.keymap_size()
+        requests = []
+        for offset in range(0, size, VIA_CHUNK):
+            chunk = min(VIA_CHUNK, size - offset)
+            requests.append([VIA_GET_BUFFER, offset >> 8, offset & 0xFF, chunk])
+        replies = self.pipeline(requests, window)
+        return b"".join(reply[4:4 + request[3]] for request, reply in zip(requests, replies))
+
+    def write_keymap(self, data, window=DEFAULT_WINDOW, bulk=True):
+        """Write the whole dynamic keymap, streaming through the bulk command when available."""
+        if bulk and self._bulk_write(data):
+            return
+        requests = []
+        for offset in range(0, len(data), VIA_CHUNK):
+            chunk = data[offset:offset + VIA_CHUNK]
+            requests.append([VIA_SET_BUFFER, offset >> 8, offset & 0xFF, len(chunk), *chunk])
+        self.pipeline(requests, window)
+
+    def _bulk_write(self, data):
+        """Returns False if the firmware lacks BULK_KEYMAP_ENABLE."""
+        reply = self.transact([OLKB_HID_COMMAND, OLKB_HID_BULK_BEGIN, 0, 0, len(data) >> 8, len(data) & 0xFF])
+        if reply[0] == OLKB_HID_UNHANDLED:
+            return False
+        if reply[2] != 0:
+            raise IOError(f"bulk write refused: {BULK_STATUS.get(reply[2], hex(reply[2]))}")
+        for seq, offset in enumerate(range(0, len(data), BULK_CHUNK)):
+            self.send([OLKB_HID_COMMAND, OLKB_HID_BULK_DATA, seq & 0xFF, *data[offset:offset + BULK_CHUNK]])
+        reply = self.transact([OLKB_HID_COMMAND, OLKB_HID_BULK_END])
+        status, written, crc = reply[2], (reply[3] << 8) | reply[4], (reply[5] << 8) | reply[6]
+        if status != 0:
+            raise IOError(f"bulk write failed: {BULK_STATUS.get(status, hex(status))}")
+        if written != len(data) or crc != crc16_ccitt(data):
+            raise IOError(f"bulk write mismatch: {written}/{len(data)} bytes, crc {crc:04x}/{crc16_ccitt(data):04x}")
+        return True
+
+
+def timed(label, func, repeat):
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = func()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    print(f" {label:<34} {best * 1000:8.1f} ms")
+    return result
+
+
+def benchmark(client, window, repeat):
+    size = client.keymap_size()
+    print(f"Full keymap: {size} bytes, best of {repeat}")
+    baseline = timed("read, stop-and-wait (Vial GUI)", lambda: client.read_keymap(window=1), repeat)
+    pipelined = timed(f"read, pipelined (window {window})", lambda: client.read_keymap(window=window), repeat)
+    if baseline != pipelined:
+        print("Error: pipelined readback differs from stop-and-wait readback.")
+        sys.exit(1)
+    # Writing back what was read leaves the keymap unchanged
+    timed("write, stop-and-wait (Vial GUI)", lambda: client.write_keymap(baseline, window=1, bulk=False), repeat)
+    timed(f"write, pipelined (window {window})", lambda: client.write_keymap(baseline, window=window, bulk=False), repeat)
+    timed("write, bulk stream", lambda: client.write_keymap(baseline, window=window), repeat)
+    if client.read_keymap(window=window) != baseline:
+        print("Error: keymap changed during the write benchmark.")
+        sys.exit(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pipelined keymap transfer for the converted Planck Rev6 firmware.")
+    parser.add_argument("--window", type=int, default=DEFAULT_WINDOW, help="requests kept in flight")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("dump", help="read the dynamic keymap to a file").add_argument("file")
+    sub.add_parser("load", help="write a file to the dynamic keymap").add_argument("file")
+    bench = sub.add_parser("bench", help="time full-keymap sync, stop-and-wait vs pipelined")
+    bench.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    client = OlkbHid.open()
+    if args.command == "dump":
+        data = client.read_keymap(args.window)
+        with open(args.file, "wb") as f:
+            f.write(data)
+        print(f"Read {len(data)} bytes into {args.file}")
+    elif args.command == "load":
+        with open(args.file, "rb") as f:
+            data = f.read()
+        if len(data) != client.keymap_size():
+            print(f"Error: {args.file} has {len(data)} bytes, the keyboard holds {client.keymap_size()}.")
+            sys.exit(1)
+        client.write_keymap(data, args.window)
+        print(f"Wrote {len(data)} bytes from {args.file}")
+    else:
+        benchmark(client, args.window, args.repeat)
+
+
+if __name__ == "__main__":
+    main()
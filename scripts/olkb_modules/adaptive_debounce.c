@@ -0,0 +1,89 @@
+#include "adaptive_debounce.h"
+#include "debounce.h"
+
+_Static_assert(ADAPTIVE_DEBOUNCE_DECAY_PRESSES >= 1 && ADAPTIVE_DEBOUNCE_DECAY_PRESSES <= UINT8_MAX, "ADAPTIVE_DEBOUNCE_DECAY_PRESSES must be from 1 to 255");
+
+static uint8_t      chatter[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t      clean[MATRIX_ROWS][MATRIX_COLS]; /* clean presses since the last count change */
+static uint16_t     pending_since[MATRIX_ROWS][MATRIX_COLS];
+static uint16_t     last_release[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t pending[MATRIX_ROWS];
+static bool         any_pending;
+
+uint8_t adaptive_debounce_chatter(uint8_t row, uint8_t col) {
+    return chatter[row][col];
+}
+
+uint8_t adaptive_debounce_window(uint8_t row, uint8_t col) {
+    uint16_t window = ADAPTIVE_DEBOUNCE_MIN_MS + chatter[row][col] * ADAPTIVE_DEBOUNCE_STEP_MS;
+    return window < ADAPTIVE_DEBOUNCE_MAX_MS ? window : ADAPTIVE_DEBOUNCE_MAX_MS;
+}
+
+void debounce_init(uint8_t num_rows) {
+    /* No key has a recent release at boot, so a first press is never chatter */
+    uint16_t long_ago = timer_read() - ADAPTIVE_DEBOUNCE_CHATTER_MS;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            last_release[row][col] = long_ago;
+        }
+    }
+}
+
+void debounce_free(void) {}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    if (!changed && !any_pending) {
+        return false;
+    }
+    uint16_t now           = timer_read();
+    bool     cooked_change = false;
+    any_pending            = false;
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t diff = raw[row] ^ cooked[row];
+        /* A key that bounced back to its cooked state restarts from scratch */
+        matrix_row_t started = diff & ~pending[row];
+        pending[row]         = diff;
+
+        for (matrix_row_t bits = diff; bits; bits &= bits - 1) {
+            uint8_t      col = __builtin_ctz(bits);
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            if (started & bit) {
+                pending_since[row][col] = now;
+            }
+            if (TIMER_DIFF_16(now, pending_since[row][col]) < adaptive_debounce_window(row, col)) {
+                continue;
+            }
+            cooked[row] ^= bit;
+            pending[row] &= ~bit;
+            cooked_change = true;
+            if (!(cooked[row] & bit)) {
+                last_release[row][col] = now;
+            } else if (TIMER_DIFF_16(now, last_release[row][col]) < ADAPTIVE_DEBOUNCE_CHATTER_MS) {
+                if (chatter[row][col] < UINT8_MAX) {
+                    chatter[row][col]++;
+                }
+                clean[row][col] = 0;
+            } else if (chatter[row][col] && ++clean[row][col] >= ADAPTIVE_DEBOUNCE_DECAY_PRESSES) {
+                chatter[row][col]--;
+                clean[row][col] = 0;
+            }
+        }
+        if (pending[row]) {
+            any_pending = true;
+        }
+    }
+    return cooked_change;
+}
+
+void adaptive_debounce_hid(uint8_t *data, uint8_t length) {
+    uint8_t first = data[0];
+    uint8_t count = 0;
+    while (2 + (count + 1) * 2 <= length && first + count < MATRIX_ROWS * MATRIX_COLS) {
+        uint8_t key             = first + count;
+        data[2 + count * 2]     = adaptive_debounce_chatter(key / MATRIX_COLS, key % MATRIX_COLS);
+        data[2 + count * 2 + 1] = adaptive_debounce_window(key / MATRIX_COLS, key % MATRIX_COLS);
+        count++;
+    }
+    data[1] = count;
+}
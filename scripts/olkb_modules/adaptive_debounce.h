@@ -0,0 +1,40 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Per-key adaptive debounce (DEBOUNCE_TYPE = custom). Each key is debounced
+ * with its own defer window: a raw change is taken once it has been stable
+ * for the window. A cooked release followed by a press within
+ * ADAPTIVE_DEBOUNCE_CHATTER_MS counts as chatter on that key and widens
+ * its window; keys that never chatter stay at the minimum. The threshold
+ * sits below the shortest release of a deliberate retap (double taps and
+ * trills leave the key up for 20 ms or more), so only contact bounce counts.
+ * Every ADAPTIVE_DEBOUNCE_DECAY_PRESSES clean presses take one count back,
+ * so a key that chattered once narrows again.
+ */
+
+#ifndef ADAPTIVE_DEBOUNCE_MIN_MS
+#    define ADAPTIVE_DEBOUNCE_MIN_MS 2
+#endif
+#ifndef ADAPTIVE_DEBOUNCE_STEP_MS
+#    define ADAPTIVE_DEBOUNCE_STEP_MS 2
+#endif
+#ifndef ADAPTIVE_DEBOUNCE_MAX_MS
+#    define ADAPTIVE_DEBOUNCE_MAX_MS 20
+#endif
+#ifndef ADAPTIVE_DEBOUNCE_CHATTER_MS
+#    define ADAPTIVE_DEBOUNCE_CHATTER_MS 10
+#endif
+#ifndef ADAPTIVE_DEBOUNCE_DECAY_PRESSES
+#    define ADAPTIVE_DEBOUNCE_DECAY_PRESSES 64
+#endif
+
+uint8_t adaptive_debounce_chatter(uint8_t row, uint8_t col);
+uint8_t adaptive_debounce_window(uint8_t row, uint8_t col);
+
+/*
+ * Raw HID reply: request payload is the first key index (row * MATRIX_COLS
+ * + col); reply is [first, count, (chatter, window_ms) x count]
+ */
+void adaptive_debounce_hid(uint8_t *data, uint8_t length);
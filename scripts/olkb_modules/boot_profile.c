@@ -0,0 +1,129 @@
+#include "boot_profile.h"
+#include "olkb_hid.h"
+
+#ifdef KEYTIME_ENABLE
+#    include "keytime.h"
+#endif
+
+#if !defined(KEYTIME_ENABLE) && defined(PROTOCOL_CHIBIOS)
+#    include <hal.h>
+
+#    define BOOT_PROFILE_CYCLES_PER_US (STM32_SYSCLK / 1000000U)
+
+/* DWT count at PRE_INIT, carrying its timebase across timer_init() */
+static uint32_t pre_init_cycles;
+static bool     bridged;
+#endif
+
+static uint32_t phase_us[BOOT_PHASE_COUNT];
+static uint8_t  reached;
+static uint32_t base_us;
+
+static uint32_t boot_profile_now_us(void) {
+#ifdef KEYTIME_ENABLE
+    /* keytime starts counting at keyboard_pre_init_user */
+    return base_us + keytime_now_us();
+#else
+#    ifdef PROTOCOL_CHIBIOS
+    if (!bridged && boot_profile_reached(BOOT_PHASE_PRE_INIT)) {
+        /* The first mark after PRE_INIT follows timer_init()'s rebase of
+           timer_read32(), well inside the cycle counter's ~60 s wrap, so the
+           cycles since PRE_INIT give the offset back to its timebase */
+        uint32_t since_pre_init = (DWT->CYCCNT - pre_init_cycles) / BOOT_PROFILE_CYCLES_PER_US;
+        base_us                 = phase_us[BOOT_PHASE_PRE_INIT] + since_pre_init - timer_read32() * 1000U;
+        bridged                 = true;
+    }
+#    endif
+    return base_us + timer_read32() * 1000U;
+#endif
+}
+
+void boot_profile_mark(boot_phase_t phase) {
+    if (boot_profile_reached(phase)) {
+        return;
+    }
+    if (phase == BOOT_PHASE_PRE_INIT) {
+#ifdef KEYTIME_ENABLE
+        /* QMK's timer_init() has not rebased timer_read32() yet, so this is
+           milliseconds since the RTOS tick started */
+        base_us = timer_read32() * 1000U;
+#elif defined(PROTOCOL_CHIBIOS)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        pre_init_cycles = DWT->CYCCNT;
+#endif
+    }
+    phase_us[phase] = boot_profile_now_us();
+    reached |= 1 << phase;
+}
+
+bool boot_profile_reached(boot_phase_t phase) {
+    return reached & (1 << phase);
+}
+
+void boot_profile_keyboard_report(const report_keyboard_t *report) {
+    bool keys = report->mods;
+    for (uint8_t i = 0; i < sizeof(report->keys) && !keys; i++) {
+        keys = report->keys[i];
+    }
+    if (keys) {
+        boot_profile_mark(BOOT_PHASE_FIRST_REPORT);
+    }
+}
+
+void boot_profile_nkro_report(const report_nkro_t *report) {
+    bool keys = report->mods;
+    for (uint8_t i = 0; i < sizeof(report->bits) && !keys; i++) {
+        keys = report->bits[i];
+    }
+    if (keys) {
+        boot_profile_mark(BOOT_PHASE_FIRST_REPORT);
+    }
+}
+
+#ifndef USB_STATS_ENABLE
+static host_driver_t  watched_driver;
+static host_driver_t *usb_driver;
+
+static void watched_send_keyboard(report_keyboard_t *report) {
+    boot_profile_keyboard_report(report);
+    usb_driver->send_keyboard(report);
+}
+
+static void watched_send_nkro(report_nkro_t *report) {
+    boot_profile_nkro_report(report);
+    usb_driver->send_nkro(report);
+}
+#endif
+
+void boot_profile_task(void) {
+#ifndef USB_STATS_ENABLE
+    /* usb_stats reports sends itself; otherwise wrap the driver until the first key report */
+    host_driver_t *driver = host_get_driver();
+    if (boot_profile_reached(BOOT_PHASE_FIRST_REPORT)) {
+        if (driver == &watched_driver) {
+            host_set_driver(usb_driver);
+        }
+        return;
+    }
+    if (driver == NULL || driver == &watched_driver) {
+        return;
+    }
+    usb_driver                   = driver;
+    watched_driver               = *driver;
+    watched_driver.send_keyboard = watched_send_keyboard;
+    watched_driver.send_nkro     = watched_send_nkro;
+    host_set_driver(&watched_driver);
+#endif
+}
+
+void boot_profile_hid(uint8_t *data, uint8_t length) {
+    uint8_t count = BOOT_PHASE_COUNT;
+    if (1 + count * 4 > length) {
+        count = (length - 1) / 4;
+    }
+    data[0] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        olkb_hid_put_u32(&data[1 + i * 4], boot_profile_reached(i) ? phase_us[i] : 0);
+    }
+}
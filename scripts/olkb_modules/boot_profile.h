@@ -0,0 +1,42 @@
+#pragma once
+
+#include "quantum.h"
+#include "host.h"
+
+/*
+ * Boot phase timestamps in microseconds since the RTOS started. Without
+ * KEYTIME_ENABLE, later phases have millisecond resolution; the DWT cycle
+ * counter carries PRE_INIT's stamp across QMK's timer_init() rebase.
+ * The QMK init hooks bracket the core phases:
+ *   PRE_INIT    clocks and the EEPROM/wear-leveling driver are up
+ *   MATRIX_INIT VIA/Vial init is done (via_init() runs before matrix_init())
+ *   POST_INIT   quantum and audio init are done
+ *   FIRST_SCAN  first matrix scan finished
+ *   LAZY_INIT   deferred subsystems (startup song, module calibration) started
+ *   FIRST_REPORT first keyboard report holding a key or modifier was handed
+ *               to the host driver (a layer key or a pending dance sends none)
+ */
+typedef enum {
+    BOOT_PHASE_PRE_INIT,
+    BOOT_PHASE_MATRIX_INIT,
+    BOOT_PHASE_POST_INIT,
+    BOOT_PHASE_FIRST_SCAN,
+    BOOT_PHASE_LAZY_INIT,
+    BOOT_PHASE_FIRST_REPORT,
+    BOOT_PHASE_COUNT,
+} boot_phase_t;
+
+/* Record `phase` once; later calls for the same phase are ignored */
+void boot_profile_mark(boot_phase_t phase);
+
+bool boot_profile_reached(boot_phase_t phase);
+
+/* Mark FIRST_REPORT if the report holds a key or modifier; called by whoever wraps the host driver */
+void boot_profile_keyboard_report(const report_keyboard_t *report);
+void boot_profile_nkro_report(const report_nkro_t *report);
+
+/* Watches the host driver for the first key report (usb_stats does it when enabled); called from housekeeping */
+void boot_profile_task(void);
+
+/* OLKB_HID_BOOT_PROFILE response: [count, u32 stamp * count], 0 = not reached */
+void boot_profile_hid(uint8_t *data, uint8_t length);
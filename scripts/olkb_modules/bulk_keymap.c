@@ -0,0 +1,90 @@
+#include "bulk_keymap.h"
+#include "olkb_hid.h"
+#include "dynamic_keymap.h"
+
+#ifdef VIAL_ENABLE
+#    include "vial.h"
+#endif
+
+static bool     active;
+static uint8_t  status = BULK_KEYMAP_IDLE;
+static uint8_t  next_seq;
+static uint16_t offset;
+static uint16_t remaining;
+static uint16_t written;
+static uint16_t crc;
+
+static uint16_t crc16_ccitt(uint16_t value, const uint8_t *data, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        value ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            value = (value & 0x8000) ? (value << 1) ^ 0x1021 : value << 1;
+        }
+    }
+    return value;
+}
+
+static void bulk_keymap_abort(uint8_t reason) {
+    active = false;
+    status = reason;
+}
+
+bool bulk_keymap_begin(uint8_t *data, uint8_t length) {
+    uint16_t start = (data[0] << 8) | data[1];
+    uint16_t size  = (data[2] << 8) | data[3];
+    active         = false;
+#ifdef VIAL_ENABLE
+    if (!vial_unlocked) {
+        status  = BULK_KEYMAP_LOCKED;
+        data[0] = status;
+        return true;
+    }
+#endif
+    if ((uint32_t)start + size > dynamic_keymap_get_layer_count() * MATRIX_ROWS * MATRIX_COLS * 2) {
+        status  = BULK_KEYMAP_RANGE;
+        data[0] = status;
+        return true;
+    }
+    active    = true;
+    status    = BULK_KEYMAP_OK;
+    next_seq  = 0;
+    offset    = start;
+    remaining = size;
+    written   = 0;
+    crc       = 0xFFFF;
+    data[0]   = status;
+    return true;
+}
+
+bool bulk_keymap_data(uint8_t *data, uint8_t length) {
+    if (!active) {
+        return false;
+    }
+    uint8_t seq   = data[0];
+    uint8_t count = length - 1;
+    if (seq != next_seq) {
+        bulk_keymap_abort(BULK_KEYMAP_SEQUENCE);
+        return false;
+    }
+    if (count > remaining) {
+        count = remaining;
+    }
+    dynamic_keymap_set_buffer(offset + written, count, &data[1]);
+    crc = crc16_ccitt(crc, &data[1], count);
+    written += count;
+    remaining -= count;
+    next_seq++;
+    return false;
+}
+
+bool bulk_keymap_end(uint8_t *data, uint8_t length) {
+    if (active && remaining) {
+        bulk_keymap_abort(BULK_KEYMAP_SEQUENCE);
+    }
+    active  = false;
+    data[0] = status;
+    olkb_hid_put_u16(&data[1], written);
+    olkb_hid_put_u16(&data[3], crc);
+    status = BULK_KEYMAP_IDLE;
+    return true;
+}
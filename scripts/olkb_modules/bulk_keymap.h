@@ -0,0 +1,30 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Sequenced bulk writes into the dynamic keymap buffer (the same byte range
+ * VIA's dynamic_keymap_set_buffer addresses). The host opens a transfer,
+ * streams DATA reports without waiting for replies, and reads one reply at
+ * the end with the byte count and a CRC-16/CCITT of what was written:
+ *
+ *   BEGIN [offset u16, length u16]          -> [status]
+ *   DATA  [seq u8, bytes...]                -> no reply
+ *   END   []                                -> [status, written u16, crc u16]
+ *
+ * A sequence gap aborts the transfer and END reports it.
+ * With Vial, writes need the keyboard to be unlocked.
+ */
+
+enum bulk_keymap_status {
+    BULK_KEYMAP_OK       = 0x00,
+    BULK_KEYMAP_LOCKED   = 0x01,
+    BULK_KEYMAP_RANGE    = 0x02,
+    BULK_KEYMAP_SEQUENCE = 0x03,
+    BULK_KEYMAP_IDLE     = 0x04,
+};
+
+/* Each handler fills the reply payload; false means send no reply */
+bool bulk_keymap_begin(uint8_t *data, uint8_t length);
+bool bulk_keymap_data(uint8_t *data, uint8_t length);
+bool bulk_keymap_end(uint8_t *data, uint8_t length);
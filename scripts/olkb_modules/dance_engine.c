@@ -0,0 +1,199 @@
+#include "dance_engine.h"
+
+typedef struct {
+    tap_dance_state_t state;
+    keypos_t          key;
+    uint16_t          index;
+    uint16_t          timer;
+    uint16_t          term;
+    uint8_t           order; /* press order among slots in flight */
+    bool              used;
+    bool              ready; /* released and rolled past: finish now */
+} dance_slot_t;
+
+static dance_slot_t slots[DANCE_ENGINE_SLOTS];
+static uint8_t      next_order;
+/* MT()/LT() presses QMK's tapping buffer still holds */
+static uint8_t  buffered_taps;
+static uint16_t buffered_since;
+
+static bool is_tap_hold(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+/* True while the tapping buffer would queue an event behind an unresolved key */
+static bool tapping_buffered(void) {
+    if (buffered_taps && TIMER_DIFF_16(timer_read(), buffered_since) > DANCE_ENGINE_STALE_MS) {
+        buffered_taps = 0;
+    }
+    return buffered_taps != 0;
+}
+
+static void call(dance_slot_t *slot, tap_dance_user_fn_t fn) {
+    if (fn) {
+        fn(&slot->state, tap_dance_get(slot->index)->user_data);
+    }
+}
+
+static void release_slot(dance_slot_t *slot) {
+    call(slot, tap_dance_get(slot->index)->fn.on_reset);
+    slot->used = false;
+}
+
+static void finish(dance_slot_t *slot) {
+    slot->state.finished = true;
+    call(slot, tap_dance_get(slot->index)->fn.on_dance_finished);
+    if (!slot->state.pressed) {
+        release_slot(slot);
+    }
+}
+
+/* Rolled past, or its tapping term ran out since its last tap */
+static bool is_due(const dance_slot_t *slot) {
+    return slot->ready || TIMER_DIFF_16(timer_read(), slot->timer) >= slot->term;
+}
+
+/* Earliest-pressed slot in flight that has not finished yet (and is due, if asked) */
+static dance_slot_t *oldest_unfinished(bool due_only) {
+    dance_slot_t *oldest = NULL;
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        dance_slot_t *slot = &slots[i];
+        if (slot->used && !slot->state.finished && (!due_only || is_due(slot)) && (!oldest || (uint8_t)(slot->order - oldest->order) & 0x80)) {
+            oldest = slot;
+        }
+    }
+    return oldest;
+}
+
+/*
+ * Finish every dance that is due, in press order. A dance still inside its
+ * term holds back no other: each is decided on its own term.
+ */
+static void finish_due(bool interrupt, uint16_t interrupting_keycode) {
+    dance_slot_t *slot;
+    while ((slot = oldest_unfinished(!interrupt))) {
+        if (interrupt) {
+            slot->state.interrupted          = true;
+            slot->state.interrupting_keycode = interrupting_keycode;
+        }
+        finish(slot);
+    }
+}
+
+/* A released dance rolled past by a later dance key gets no further taps */
+static void roll_past(uint16_t keycode) {
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        dance_slot_t *slot = &slots[i];
+        if (slot->used && !slot->state.finished && !slot->state.pressed) {
+            slot->ready                      = true;
+            slot->state.interrupted          = true;
+            slot->state.interrupting_keycode = keycode;
+        }
+    }
+}
+
+static bool pressed_after(const dance_slot_t *slot) {
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        if (slots[i].used && ((uint8_t)(slot->order - slots[i].order) & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static dance_slot_t *find_slot(keypos_t key) {
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        if (slots[i].used && KEYEQ(slots[i].key, key)) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+static dance_slot_t *new_slot(void) {
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        if (!slots[i].used) {
+            return &slots[i];
+        }
+    }
+    /* Full: settle the oldest dance still undecided and take a free slot */
+    dance_slot_t *oldest = oldest_unfinished(false);
+    if (oldest) {
+        oldest->state.interrupted = true;
+        finish(oldest);
+    }
+    for (uint8_t i = 0; i < DANCE_ENGINE_SLOTS; i++) {
+        if (!slots[i].used) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+bool dance_engine_record(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_EVENT(record->event)) {
+        return true;
+    }
+    if (!IS_QK_TAP_DANCE(keycode) || QK_TAP_DANCE_GET_INDEX(keycode) >= tap_dance_count()) {
+        if (record->event.pressed) {
+            finish_due(true, keycode);
+            if (is_tap_hold(keycode)) {
+                buffered_taps++;
+                buffered_since = record->event.time;
+            }
+        }
+        return true;
+    }
+
+    keypos_t      key  = record->event.key;
+    dance_slot_t *slot = find_slot(key);
+    if (!slot && (!record->event.pressed || tapping_buffered())) {
+        /* Not ours, or it must queue behind a tap-hold key: QMK's tap dance takes it */
+        return true;
+    }
+    if (record->event.pressed) {
+        if (slot && slot->state.finished) {
+            /* Pressed again before its release was seen: start over */
+            release_slot(slot);
+            slot = NULL;
+        }
+        if (!slot) {
+            roll_past(keycode);
+            slot = new_slot();
+            if (!slot) {
+                return true;
+            }
+            memset(&slot->state, 0, sizeof(slot->state));
+            slot->used  = true;
+            slot->key   = key;
+            slot->index = QK_TAP_DANCE_GET_INDEX(keycode);
+            slot->order = next_order++;
+            slot->ready = false;
+            slot->term  = GET_TAPPING_TERM(keycode, record);
+        }
+        slot->state.count++;
+        slot->state.pressed = true;
+        slot->timer         = timer_read();
+        call(slot, tap_dance_get(slot->index)->fn.on_each_tap);
+    } else if (slot) {
+        slot->state.pressed = false;
+        call(slot, tap_dance_get(slot->index)->fn.on_each_release);
+        if (slot->state.finished) {
+            release_slot(slot);
+        } else if (pressed_after(slot)) {
+            roll_past(QK_TAP_DANCE | slot->index);
+        }
+    }
+    finish_due(false, 0);
+    return false;
+}
+
+void dance_engine_process(uint16_t keycode, keyrecord_t *record) {
+    if (is_tap_hold(keycode) && record->event.pressed && buffered_taps) {
+        buffered_taps--;
+    }
+}
+
+void dance_engine_task(void) {
+    finish_due(false, 0);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Per-key tap dance engine. QMK tracks one active dance and force-finishes
+ * it when any other key goes down, so rolling across dance keys resolves
+ * each one early as an interrupted tap. Here every dance key gets its own
+ * slot and state: pressing another dance key does not interrupt, and each
+ * dance finishes on its own tapping term, never waiting for an earlier one
+ * that is still undecided. Dances that fall due together finish in press
+ * order. A press of a non-dance key interrupts every dance in flight,
+ * as in QMK. The Oryx dance callbacks are called unchanged.
+ *
+ * pre_process_record runs ahead of QMK's tapping buffer, so while an MT()
+ * or LT() key is still unresolved a new dance press is left to QMK's own
+ * tap dance code, queued behind that key. So is a press with no free slot.
+ * A dance the engine already owns keeps getting its release.
+ */
+
+/* Dances that can be in flight at once; the oldest is finished to make room */
+#ifndef DANCE_ENGINE_SLOTS
+#    define DANCE_ENGINE_SLOTS 4
+#endif
+
+/* A tap-hold key whose resolution was never seen (a record swallowed upstream) stops deferring dances after this */
+#ifndef DANCE_ENGINE_STALE_MS
+#    define DANCE_ENGINE_STALE_MS 1000
+#endif
+
+/* Called from pre_process_record_user; returns false for the dance keys it owns */
+bool dance_engine_record(uint16_t keycode, keyrecord_t *record);
+
+/* Called from process_record_user: a tap-hold press seen here has left the tapping buffer */
+void dance_engine_process(uint16_t keycode, keyrecord_t *record);
+
+/* Finishes dances whose tapping term ran out; called from housekeeping */
+void dance_engine_task(void);
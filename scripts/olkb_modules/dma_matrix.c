@@ -0,0 +1,233 @@
+#include "dma_matrix.h"
+#include "matrix.h"
+#include "olkb_hid.h"
+#include <hal.h>
+
+#ifdef KEYTIME_ENABLE
+#    include "keytime.h"
+#endif
+
+#define ROW_PORTS 3
+#define COL_PORTS 2
+#define FRAME_SLOTS (MATRIX_ROWS * 2)
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+static stm32_gpio_t *row_ports[ROW_PORTS];
+static stm32_gpio_t *col_ports[COL_PORTS];
+static uint8_t       col_port_index[MATRIX_COLS];
+
+/* One BSRR word per row and row port: reset the strobed row, set the others */
+static uint32_t strobe[ROW_PORTS][MATRIX_ROWS];
+/* Column port IDR per row, two frames */
+static volatile uint32_t samples[COL_PORTS][FRAME_SLOTS];
+
+/* TIM1 request -> DMA1 channel on the F303 */
+static const uint32_t strobe_streams[ROW_PORTS] = {STM32_DMA_STREAM_ID(1, 2), STM32_DMA_STREAM_ID(1, 3), STM32_DMA_STREAM_ID(1, 6)};
+static const uint32_t sample_streams[COL_PORTS] = {STM32_DMA_STREAM_ID(1, 4), STM32_DMA_STREAM_ID(1, 5)};
+
+/* Strobe streams first, then sample streams; NULL until allocated */
+static const stm32_dma_stream_t *streams[ROW_PORTS + COL_PORTS];
+static bool                      dma_running;
+
+static volatile uint32_t frames;      /* completed frames */
+static volatile uint8_t  ready_frame; /* frame the DMA finished last */
+static uint32_t          consumed;
+
+static dma_matrix_stats_t stats;
+static uint32_t           window_start;
+static uint32_t           window_frames;
+static uint32_t           window_scans;
+static uint32_t           window_scan_us;
+
+static uint8_t port_slot(stm32_gpio_t **ports, uint8_t count, stm32_gpio_t *port) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!ports[i] || ports[i] == port) {
+            ports[i] = port;
+            return i;
+        }
+    }
+    return count;
+}
+
+/* The update event samples last, so its channel marks frame boundaries */
+static void frame_done(void *param, uint32_t flags) {
+    (void)param;
+    ready_frame = (flags & STM32_DMA_ISR_TCIF) ? 1 : 0;
+    frames++;
+}
+
+static void start_stream(const stm32_dma_stream_t *stream, volatile void *peripheral, volatile void *memory, uint32_t size, uint32_t mode) {
+    dmaStreamSetPeripheral(stream, peripheral);
+    dmaStreamSetMemory0(stream, memory);
+    dmaStreamSetTransactionSize(stream, size);
+    dmaStreamSetMode(stream, mode | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_PL(3));
+    dmaStreamEnable(stream);
+}
+
+/* Takes every channel before any is started; all or none */
+static bool alloc_streams(void) {
+    bool ok = true;
+    for (uint8_t port = 0; port < ROW_PORTS && row_ports[port] && ok; port++) {
+        streams[port] = dmaStreamAlloc(strobe_streams[port], DMA_MATRIX_IRQ_PRIORITY, NULL, NULL);
+        ok            = streams[port] != NULL;
+    }
+    for (uint8_t port = 0; port < COL_PORTS && col_ports[port] && ok; port++) {
+        bool last                 = port == COL_PORTS - 1 || !col_ports[port + 1];
+        streams[ROW_PORTS + port] = dmaStreamAlloc(sample_streams[port], DMA_MATRIX_IRQ_PRIORITY, last ? frame_done : NULL, NULL);
+        ok                        = streams[ROW_PORTS + port] != NULL;
+    }
+    if (!ok) {
+        for (uint8_t i = 0; i < ROW_PORTS + COL_PORTS; i++) {
+            if (streams[i]) {
+                dmaStreamFree(streams[i]);
+                streams[i] = NULL;
+            }
+        }
+    }
+    return ok;
+}
+
+void matrix_init_custom(void) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        gpio_set_pin_input_high(col_pins[col]);
+        col_port_index[col] = port_slot(col_ports, COL_PORTS, PAL_PORT(col_pins[col]));
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        gpio_set_pin_output(row_pins[row]);
+        gpio_write_pin_high(row_pins[row]);
+        uint8_t port = port_slot(row_ports, ROW_PORTS, PAL_PORT(row_pins[row]));
+        for (uint8_t strobed = 0; strobed < MATRIX_ROWS; strobed++) {
+            uint32_t bit = 1U << PAL_PAD(row_pins[row]);
+            strobe[port][strobed] |= (row == strobed) ? bit << 16 : bit;
+        }
+    }
+
+    /* One channel held elsewhere (audio, say) leaves the CPU scanning */
+    if (!alloc_streams()) {
+        return;
+    }
+
+    rccEnableTIM1(true);
+    TIM1->CR1  = 0;
+    TIM1->PSC  = 0;
+    TIM1->ARR  = DMA_MATRIX_SLOT_US * (STM32_TIM1CLK / 1000000U) - 1;
+    TIM1->CCR1 = 1;
+    TIM1->CCR2 = 2;
+    TIM1->CCR3 = 3;
+    TIM1->CCR4 = TIM1->ARR - 1;
+
+    for (uint8_t port = 0; port < ROW_PORTS && row_ports[port]; port++) {
+        start_stream(streams[port], &row_ports[port]->BSRR.W, strobe[port], MATRIX_ROWS, STM32_DMA_CR_DIR_M2P);
+    }
+    for (uint8_t port = 0; port < COL_PORTS && col_ports[port]; port++) {
+        bool last = port == COL_PORTS - 1 || !col_ports[port + 1];
+        start_stream(streams[ROW_PORTS + port], &col_ports[port]->IDR, samples[port], FRAME_SLOTS, STM32_DMA_CR_DIR_P2M | (last ? STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE : 0));
+    }
+
+    TIM1->DIER  = TIM_DIER_CC1DE | TIM_DIER_CC2DE | TIM_DIER_CC3DE | TIM_DIER_CC4DE | TIM_DIER_UDE;
+    TIM1->CR1   = TIM_CR1_CEN;
+    dma_running = true;
+}
+
+/* Fallback when the DMA channels are taken: the stock row-by-row scan */
+static void scan_rows(matrix_row_t rows[]) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        gpio_write_pin_low(row_pins[row]);
+        wait_us(MATRIX_IO_DELAY);
+        rows[row] = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (!gpio_read_pin(col_pins[col])) {
+                rows[row] |= (matrix_row_t)1 << col;
+            }
+        }
+        gpio_write_pin_high(row_pins[row]);
+    }
+}
+
+static matrix_row_t decode_row(uint8_t frame, uint8_t row) {
+    matrix_row_t bits = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        uint32_t idr = samples[col_port_index[col]][frame * MATRIX_ROWS + row];
+        /* Rows pull a pressed key's column low */
+        if (!(idr & (1U << PAL_PAD(col_pins[col])))) {
+            bits |= (matrix_row_t)1 << col;
+        }
+    }
+    return bits;
+}
+
+static void dma_matrix_account(uint32_t started_us) {
+#ifdef KEYTIME_ENABLE
+    uint32_t now = keytime_now_us();
+    window_scans++;
+    window_scan_us += now - started_us;
+    if (now - window_start < 1000000U) {
+        return;
+    }
+    uint32_t elapsed     = now - window_start;
+    uint32_t frame_count = frames;
+    stats.frame_hz       = (uint64_t)(frame_count - window_frames) * 1000000U / elapsed;
+    stats.scan_hz        = (uint64_t)window_scans * 1000000U / elapsed;
+    stats.scan_ns        = (uint64_t)window_scan_us * 1000U / window_scans;
+    window_start         = now;
+    window_frames        = frame_count;
+    window_scans         = 0;
+    window_scan_us       = 0;
+#endif
+}
+
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+#ifdef KEYTIME_ENABLE
+    uint32_t started_us = keytime_now_us();
+#else
+    uint32_t started_us = 0;
+#endif
+    bool         changed = false;
+    bool         fresh   = !dma_running;
+    uint32_t     count   = frames;
+    matrix_row_t rows[MATRIX_ROWS];
+
+    if (!dma_running) {
+        scan_rows(rows);
+    } else if (count != consumed) {
+        /* Copy the finished frame, again if the DMA came back round to it meanwhile */
+        uint8_t frame;
+        do {
+            count = frames;
+            frame = ready_frame;
+            for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                rows[row] = decode_row(frame, row);
+            }
+        } while (frames != count);
+
+        if (count - consumed > 1) {
+            stats.frames_skipped += count - consumed - 1;
+        }
+        consumed = count;
+        fresh    = true;
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS && fresh; row++) {
+        if (current_matrix[row] != rows[row]) {
+            current_matrix[row] = rows[row];
+            changed             = true;
+        }
+    }
+    dma_matrix_account(started_us);
+    return changed;
+}
+
+const dma_matrix_stats_t *dma_matrix_stats(void) {
+    return &stats;
+}
+
+void dma_matrix_hid(uint8_t *data, uint8_t length) {
+    if (length < 16) {
+        return;
+    }
+    olkb_hid_put_u32(&data[0], stats.frame_hz);
+    olkb_hid_put_u32(&data[4], stats.scan_hz);
+    olkb_hid_put_u32(&data[8], stats.scan_ns);
+    olkb_hid_put_u32(&data[12], stats.frames_skipped);
+}
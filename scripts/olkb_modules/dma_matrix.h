@@ -0,0 +1,45 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Background matrix sampling for the Planck Rev6 (STM32F303,
+ * CUSTOM_MATRIX = lite). TIM1 paces a DMA chain with one row per timer
+ * period: CC1/CC2/CC3 write the row strobe pattern to the BSRR of each row
+ * port, CC4 and the update event copy the column ports' IDR into a
+ * two-frame circular buffer. The CPU only decodes the last completed frame,
+ * so the scan rate is fixed by the timer whatever the keymap hooks cost.
+ *
+ * Needs TIM1 and DMA1 channels 2-6. If any of those channels is already
+ * allocated (by audio, say), none is started and matrix_scan_custom() scans
+ * the rows from the CPU instead; frame_hz then stays 0. Rows may span up to
+ * three GPIO ports and columns up to two (the Rev6 uses A/B/C and A/B).
+ */
+
+/* Settle time the stock scanner waits after strobing a row */
+#ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#endif
+
+/* One row's slot: strobe, settle, sample. The sample comes at the end of the slot */
+#ifndef DMA_MATRIX_SLOT_US
+#    define DMA_MATRIX_SLOT_US (MATRIX_IO_DELAY + 1)
+#endif
+
+/* NVIC priority of the frame-complete interrupt */
+#ifndef DMA_MATRIX_IRQ_PRIORITY
+#    define DMA_MATRIX_IRQ_PRIORITY 8
+#endif
+
+/* Rates need KEYTIME_ENABLE; compare scan_ns with DEBUG_MATRIX_SCAN_RATE on the stock scanner */
+typedef struct {
+    uint32_t frame_hz;       /* complete matrix frames sampled per second; 0 without DMA */
+    uint32_t scan_hz;        /* matrix_scan_custom calls per second */
+    uint32_t scan_ns;        /* average CPU time of one matrix_scan_custom */
+    uint32_t frames_skipped; /* frames overwritten before a scan read them */
+} dma_matrix_stats_t;
+
+const dma_matrix_stats_t *dma_matrix_stats(void);
+
+/* Raw HID reply: frame_hz, scan_hz, scan_ns, frames_skipped as u32 */
+void dma_matrix_hid(uint8_t *data, uint8_t length);
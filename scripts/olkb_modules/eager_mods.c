@@ -0,0 +1,150 @@
+#include "eager_mods.h"
+
+typedef struct {
+    uint16_t keycode;
+    uint8_t  mods; /* bits this module added, 0 = free slot */
+} eager_slot_t;
+
+typedef struct {
+    uint16_t keycode; /* 0 = free */
+    uint16_t time;
+} pending_t;
+
+static eager_slot_t slots[EAGER_MODS_SLOTS];
+/* Tap-hold keys and dances pressed but not resolved yet */
+static pending_t pending[EAGER_MODS_SLOTS];
+
+static uint8_t mod_tap_bits(uint16_t keycode) {
+    uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    /* 5-bit MOD_xxx encoding: bit 4 selects the right-hand modifiers */
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods & 0x0F;
+}
+
+static eager_slot_t *find_slot(uint16_t keycode) {
+    for (uint8_t i = 0; i < EAGER_MODS_SLOTS; i++) {
+        if (slots[i].mods && slots[i].keycode == keycode) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_dance(uint16_t keycode) {
+    return IS_QK_TAP_DANCE(keycode) && QK_TAP_DANCE_GET_INDEX(keycode) < eager_dance_mods_count;
+}
+
+static bool is_tap_hold(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode) || is_dance(keycode);
+}
+
+/* True while another key's tap may still be sent; forgets keys whose resolution was never seen */
+static bool any_pending(void) {
+    bool found = false;
+    for (uint8_t i = 0; i < EAGER_MODS_SLOTS; i++) {
+        if (pending[i].keycode && timer_elapsed(pending[i].time) > EAGER_MODS_STALE_MS) {
+            pending[i].keycode = 0;
+        }
+        found |= pending[i].keycode != 0;
+    }
+    return found;
+}
+
+static void pending_add(uint16_t keycode, uint16_t time) {
+    pending_t *free_entry = NULL;
+    for (uint8_t i = 0; i < EAGER_MODS_SLOTS; i++) {
+        if (pending[i].keycode == keycode) {
+            pending[i].time = time;
+            return;
+        }
+        if (!pending[i].keycode && !free_entry) {
+            free_entry = &pending[i];
+        }
+    }
+    if (free_entry) {
+        free_entry->keycode = keycode;
+        free_entry->time    = time;
+    }
+}
+
+static void pending_remove(uint16_t keycode) {
+    for (uint8_t i = 0; i < EAGER_MODS_SLOTS; i++) {
+        if (pending[i].keycode == keycode) {
+            pending[i].keycode = 0;
+        }
+    }
+}
+
+static void apply(uint16_t keycode, uint8_t bits) {
+    /* Only take over modifiers that are not already down for another reason */
+    bits &= EAGER_MODS_MASK & ~get_mods();
+    if (!bits || find_slot(keycode)) {
+        return;
+    }
+    for (uint8_t i = 0; i < EAGER_MODS_SLOTS; i++) {
+        if (!slots[i].mods) {
+            slots[i].keycode = keycode;
+            slots[i].mods    = bits;
+            add_mods(bits);
+            send_keyboard_report();
+            return;
+        }
+    }
+}
+
+/* tap_sends: a tap key is registered right after, whose report drops the modifier */
+static void resolve(eager_slot_t *slot, bool hold, bool tap_sends) {
+    if (!hold) {
+        if (slot->mods & (MOD_MASK_GUI | MOD_MASK_ALT)) {
+            tap_code(EAGER_MODS_NEUTRALIZER);
+        }
+        del_mods(slot->mods);
+        /* A dance step or multi-tap may send nothing, and the host would keep the modifier */
+        if (!tap_sends) {
+            send_keyboard_report();
+        }
+    }
+    /* On hold the modifier now belongs to QMK or the dance, which releases it */
+    slot->mods = 0;
+}
+
+void eager_mods_record(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_EVENT(record->event) || !record->event.pressed || !is_tap_hold(keycode)) {
+        return;
+    }
+    eager_slot_t *slot = find_slot(keycode);
+    if (slot) {
+        /* A second press makes it a multi-tap, whose taps must not carry the modifier */
+        resolve(slot, false, false);
+    }
+    bool earlier = any_pending();
+    pending_add(keycode, record->event.time);
+    /* An earlier key's tap is still to be sent and would pick up this modifier */
+    if (earlier) {
+        return;
+    }
+    if (IS_QK_MOD_TAP(keycode)) {
+        apply(keycode, mod_tap_bits(keycode));
+    } else if (is_dance(keycode)) {
+        apply(keycode, pgm_read_byte(&eager_dance_mods[QK_TAP_DANCE_GET_INDEX(keycode)]));
+    }
+}
+
+void eager_mods_process(uint16_t keycode, keyrecord_t *record) {
+    if (!(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) || !record->event.pressed) {
+        return;
+    }
+    /* QMK only processes a tap-hold press once it has settled it */
+    pending_remove(keycode);
+    eager_slot_t *slot = find_slot(keycode);
+    if (slot) {
+        resolve(slot, record->tap.count == 0, true);
+    }
+}
+
+void eager_mods_dance_resolve(uint8_t index, bool hold) {
+    pending_remove(TD(index));
+    eager_slot_t *slot = find_slot(TD(index));
+    if (slot) {
+        resolve(slot, hold, false);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Eager modifiers for MT() keys and dances whose single hold is a bare
+ * modifier: the modifier goes down on the press instead of after the
+ * tapping term. If an MT() key resolves as a tap, the modifier is cleared
+ * without a report of its own, so the next report carries the tap key
+ * and no modifier. A dance tap and a retract send the cleared report
+ * straight away, since the dance step may send no key at all.
+ *
+ * A key pressed while an earlier MT(), LT() or dance is still unresolved
+ * gets no eager modifier, since the earlier key's tap would go out with it;
+ * it resolves on QMK's timing instead. A second press of a dance retracts
+ * its modifier before the multi-tap is sent.
+ */
+
+/* Modifiers allowed to go down eagerly (8-bit MOD_BIT mask) */
+#ifndef EAGER_MODS_MASK
+#    define EAGER_MODS_MASK 0xFF
+#endif
+
+/* Tapped before retracting GUI/ALT so hosts do not see a lone GUI or Alt tap */
+#ifndef EAGER_MODS_NEUTRALIZER
+#    define EAGER_MODS_NEUTRALIZER KC_RIGHT_CTRL
+#endif
+
+#ifndef EAGER_MODS_SLOTS
+#    define EAGER_MODS_SLOTS 4
+#endif
+
+/* A pending key whose resolution was never seen (a record swallowed upstream) stops blocking after this */
+#ifndef EAGER_MODS_STALE_MS
+#    define EAGER_MODS_STALE_MS 1000
+#endif
+
+/* Per-dance single-hold modifier, generated into keymap.c by oryx_to_olkb.py */
+extern const uint8_t eager_dance_mods[] PROGMEM;
+extern const uint8_t eager_dance_mods_count;
+
+/* Called from pre_process_record_user: applies the modifier on press */
+void eager_mods_record(uint16_t keycode, keyrecord_t *record);
+
+/* Called from process_record_user once QMK has resolved an MT() key */
+void eager_mods_process(uint16_t keycode, keyrecord_t *record);
+
+/* Called from every dance_N_finished once the dance step is known */
+void eager_mods_dance_resolve(uint8_t index, bool hold);
@@ -0,0 +1,299 @@
+#include "edge_ring.h"
+#include "matrix.h"
+#include "olkb_hid.h"
+#include <hal.h>
+#ifdef ADAPTIVE_DEBOUNCE_ENABLE
+#    include "adaptive_debounce.h"
+#endif
+
+#define CYCLES_PER_US (STM32_SYSCLK / 1000000U)
+#define CYCLES_PER_MS (STM32_SYSCLK / 1000U)
+#define SETTLE_CYCLES (MATRIX_IO_DELAY * CYCLES_PER_US)
+#define BUDGET_CYCLES (EDGE_RING_TICK_BUDGET_US * CYCLES_PER_US)
+#define RING_MASK (EDGE_RING_SIZE - 1)
+
+/* Free-running uint8_t indices tell a full ring from an empty one up to 128 entries */
+_Static_assert(EDGE_RING_SIZE >= 2 && EDGE_RING_SIZE <= 128 && (EDGE_RING_SIZE & RING_MASK) == 0, "EDGE_RING_SIZE must be a power of two from 2 to 128");
+/* Dropping edges in pairs keeps a key's last edge, so its final state, right */
+_Static_assert(EDGE_RING_KEY_BACKLOG >= 2 && EDGE_RING_KEY_BACKLOG % 2 == 0, "EDGE_RING_KEY_BACKLOG must be even and at least 2");
+
+typedef struct {
+    uint32_t cycles; /* DWT stamp of the tick that first saw the new state */
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} edge_t;
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+static virtual_timer_t scan_timer;
+static edge_t          ring[EDGE_RING_SIZE];
+
+/*
+ * Producer side, owned by scan_tick. Each key's edges wait in its own
+ * backlog, oldest first, until the ring takes them; a key's edges alternate,
+ * so queued[] and the count give each one's direction.
+ */
+static volatile uint8_t  head;
+static matrix_row_t      seen[MATRIX_ROWS];   /* state at the last read of the row */
+static matrix_row_t      queued[MATRIX_ROWS]; /* state after every edge pushed so far */
+static matrix_row_t      owing[MATRIX_ROWS];  /* keys with edges in their backlog */
+static uint32_t          backlog[MATRIX_ROWS][MATRIX_COLS][EDGE_RING_KEY_BACKLOG];
+static uint8_t           owed[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t           scan_row; /* where the next tick resumes */
+static volatile uint32_t frames;
+static volatile uint32_t overflows;
+static volatile uint32_t lost;
+
+/* Consumer side, owned by matrix_scan_custom */
+static volatile uint8_t tail;
+static uint32_t         drained[MATRIX_ROWS][MATRIX_COLS]; /* stamp of each key's last edge */
+static uint32_t         applied_ms[MATRIX_ROWS][MATRIX_COLS]; /* when debounce got that edge */
+
+static edge_ring_stats_t stats;
+static uint32_t          window_start;
+static uint32_t          window_frames;
+
+static bool columns_high(void) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!gpio_read_pin(col_pins[col])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Rows pull a pressed key's column low (COL2ROW). Rows are open-drain outputs
+ * from init on; the strobe is a BSRR write, so the interrupt never
+ * read-modify-writes MODER or PUPDR under the main loop.
+ */
+static matrix_row_t read_row(uint8_t row) {
+    gpio_write_pin_low(row_pins[row]);
+    waitInputPinDelay();
+
+    matrix_row_t bits = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!gpio_read_pin(col_pins[col])) {
+            bits |= (matrix_row_t)1 << col;
+        }
+    }
+    gpio_write_pin_high(row_pins[row]);
+    return bits;
+}
+
+/*
+ * Let the columns a row held low recover, for at most MATRIX_IO_DELAY.
+ * False if the tick's budget ran out first: the next row waits for the next
+ * tick, by when they have.
+ */
+static bool settle(uint32_t tick_start) {
+    uint32_t started = DWT->CYCCNT;
+    while (!columns_high()) {
+        uint32_t now = DWT->CYCCNT;
+        if (now - started >= SETTLE_CYCLES) {
+            return true;
+        }
+        if (now - tick_start >= BUDGET_CYCLES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* A full backlog drops its two newest edges: a press and release that never reach QMK */
+static void note_edges(uint8_t row, matrix_row_t moved, uint32_t now) {
+    for (matrix_row_t bits = moved; bits; bits &= bits - 1) {
+        uint8_t col = __builtin_ctz(bits);
+        if (owed[row][col] == EDGE_RING_KEY_BACKLOG) {
+            owed[row][col] -= 2;
+            lost += 2;
+        }
+        backlog[row][col][owed[row][col]++] = now;
+    }
+    owing[row] |= moved;
+}
+
+/* Moves backlogged edges into the ring, oldest first per key, until it is full */
+static bool push_owed(void) {
+    uint8_t next  = head;
+    uint8_t limit = tail + EDGE_RING_SIZE;
+    bool    full  = false;
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (matrix_row_t bits = owing[row]; bits; bits &= bits - 1) {
+            uint8_t      col   = __builtin_ctz(bits);
+            matrix_row_t bit   = (matrix_row_t)1 << col;
+            uint8_t      taken = 0;
+            while (taken < owed[row][col] && next != limit) {
+                queued[row] ^= bit;
+                ring[next & RING_MASK] = (edge_t){.cycles = backlog[row][col][taken], .row = row, .col = col, .pressed = (queued[row] & bit) != 0};
+                next++;
+                taken++;
+            }
+            if (taken < owed[row][col]) {
+                full = true;
+                memmove(backlog[row][col], &backlog[row][col][taken], (owed[row][col] - taken) * sizeof(uint32_t));
+            } else {
+                owing[row] &= ~bit;
+            }
+            owed[row][col] -= taken;
+        }
+    }
+    __DMB();
+    head = next;
+    return full;
+}
+
+/*
+ * System tick interrupt. Reads rows from where the last tick stopped, up to
+ * the end of the matrix, moving on while EDGE_RING_TICK_BUDGET_US lasts, so
+ * the interrupt's time stays bounded however long columns take to recover.
+ * Entries are filled before head is published. Edges held back by a full
+ * ring are pushed in row order, so across keys they can reach QMK out of
+ * order; each still carries its own time.
+ */
+static void scan_tick(virtual_timer_t *vtp, void *param) {
+    (void)vtp;
+    (void)param;
+    uint32_t started = DWT->CYCCNT;
+
+    while (true) {
+        uint8_t      row     = scan_row;
+        matrix_row_t current = read_row(row);
+        note_edges(row, current ^ seen[row], started);
+        seen[row] = current;
+
+        scan_row = row + 1 < MATRIX_ROWS ? row + 1 : 0;
+        if (scan_row == 0) {
+            frames++;
+            break;
+        }
+        if ((current && !settle(started)) || DWT->CYCCNT - started >= BUDGET_CYCLES) {
+            break;
+        }
+    }
+    if (push_owed()) {
+        overflows++;
+    }
+}
+
+void matrix_init_custom(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        gpio_set_pin_input_high(col_pins[col]);
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        gpio_write_pin_high(row_pins[row]);
+        gpio_set_pin_output_open_drain(row_pins[row]);
+    }
+    window_start = timer_read32();
+
+    chVTObjectInit(&scan_timer);
+    chVTSetContinuous(&scan_timer, TIME_US2I(EDGE_RING_PERIOD_US), scan_tick, NULL);
+}
+
+static void edge_ring_account(void) {
+    uint32_t elapsed = timer_elapsed32(window_start);
+    if (elapsed < 1000) {
+        return;
+    }
+    uint32_t count  = frames;
+    stats.scan_hz   = (count - window_frames) * 1000U / elapsed;
+    stats.overflows = overflows;
+    stats.lost      = lost;
+    window_start    = timer_read32();
+    window_frames   = count;
+}
+
+/* Time debounce needs to pass a key's last edge on before it may see the next one */
+static uint32_t debounce_ms(uint8_t row, uint8_t col) {
+#ifdef ADAPTIVE_DEBOUNCE_ENABLE
+    return adaptive_debounce_window(row, col) + 1;
+#else
+    return DEBOUNCE + 1;
+#endif
+}
+
+bool matrix_scan_custom(matrix_row_t current_matrix[]) {
+    matrix_row_t applied[MATRIX_ROWS] = {0};
+    bool         changed              = false;
+    uint8_t      index                = tail;
+    uint8_t      end                  = head;
+    __DMB();
+
+    uint8_t depth = end - index;
+    if (depth > stats.high_water) {
+        stats.high_water = depth;
+    }
+
+    uint32_t now    = DWT->CYCCNT;
+    uint32_t now_ms = timer_read32();
+    for (; index != end; index++) {
+        edge_t       edge = ring[index & RING_MASK];
+        matrix_row_t bit  = (matrix_row_t)1 << edge.col;
+        /* A second edge of the same key waits for the next scan, so QMK sees both */
+        if (applied[edge.row] & bit) {
+            break;
+        }
+        /*
+         * An edge stamped a debounce window or more after the key's last one
+         * is a real press or release, not bounce: it waits until debounce has
+         * taken the last one, or debounce would merge the two. Later edges
+         * wait behind it to keep order.
+         */
+        uint32_t window = debounce_ms(edge.row, edge.col);
+        if (edge.cycles - drained[edge.row][edge.col] >= window * CYCLES_PER_MS && timer_elapsed32(applied_ms[edge.row][edge.col]) < window) {
+            break;
+        }
+        applied[edge.row] |= bit;
+        if (edge.pressed) {
+            current_matrix[edge.row] |= bit;
+        } else {
+            current_matrix[edge.row] &= ~bit;
+        }
+        drained[edge.row][edge.col]    = edge.cycles;
+        applied_ms[edge.row][edge.col] = now_ms;
+
+        uint32_t lag_us = (now - edge.cycles) / CYCLES_PER_US;
+        if (lag_us > stats.max_lag_us) {
+            stats.max_lag_us = lag_us;
+        }
+        changed = true;
+    }
+    __DMB();
+    tail = index;
+
+    edge_ring_account();
+    return changed;
+}
+
+void edge_ring_record(keyrecord_t *record) {
+    keypos_t key = record->event.key;
+    /* Combos and encoders use positions outside the matrix */
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return;
+    }
+    /* QMK stamped the event when it came out of debounce; move it back to the edge */
+    uint32_t age_ms   = (DWT->CYCCNT - drained[key.row][key.col]) / CYCLES_PER_MS;
+    record->event.time = (uint16_t)(timer_read() - age_ms) | 1;
+}
+
+const edge_ring_stats_t *edge_ring_stats(void) {
+    return &stats;
+}
+
+void edge_ring_hid(uint8_t *data, uint8_t length) {
+    if (length < 18) {
+        return;
+    }
+    olkb_hid_put_u32(&data[0], stats.scan_hz);
+    olkb_hid_put_u32(&data[4], overflows);
+    olkb_hid_put_u32(&data[8], stats.max_lag_us);
+    data[12] = EDGE_RING_SIZE;
+    data[13] = stats.high_water;
+    olkb_hid_put_u32(&data[14], lost);
+}
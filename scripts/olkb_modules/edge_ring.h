@@ -0,0 +1,80 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Interrupt-driven matrix scanning for the Planck Rev6 (CUSTOM_MATRIX =
+ * lite). A ChibiOS continuous virtual timer scans the matrix every
+ * EDGE_RING_PERIOD_US from the system tick interrupt, so a blocking hook
+ * (wait_ms in a dance reset, audio, a long macro) no longer holds back the
+ * next scan. Every key edge is stamped with the DWT cycle counter when the
+ * interrupt first sees it and pushed into a single-producer/single-consumer
+ * ring. matrix_scan_custom() drains the ring in order. It applies at most
+ * one edge per key per call. An edge stamped at least the debounce window
+ * after its key's last one (a real press or release, not contact bounce)
+ * is held, with the edges behind it, until QMK's debounce has had DEBOUNCE
+ * ms plus one for its millisecond timer to take the last one; with
+ * ADAPTIVE_DEBOUNCE_ENABLE the window is that key's own. So a press and
+ * release that both landed while QMK was busy reach it as two debounced
+ * changes instead of merging into none, while bounce is still filtered.
+ * pre_process_record_user then backdates each event's time to its edge.
+ *
+ * When the ring is full each key keeps up to EDGE_RING_KEY_BACKLOG edges of
+ * its own, with their stamps, and they are pushed on a later tick; those
+ * ticks are counted as overflows. A key that changes more often than that
+ * before the ring drains loses press/release pairs, which are counted; its
+ * last edge, and so its final state, always gets through.
+ *
+ * Rows are open-drain outputs strobed through BSRR. A tick reads rows until
+ * the matrix is done or EDGE_RING_TICK_BUDGET_US is spent; the next tick
+ * carries on from there.
+ */
+#if defined(DMA_MATRIX_ENABLE) || defined(SETTLE_CALIBRATION_ENABLE)
+#    error "EDGE_RING_ENABLE replaces the matrix scanner; it cannot be combined with DMA_MATRIX_ENABLE or SETTLE_CALIBRATION_ENABLE"
+#endif
+
+/* Scan period; rounded up to whole system ticks */
+#ifndef EDGE_RING_PERIOD_US
+#    define EDGE_RING_PERIOD_US 250
+#endif
+
+/* Edges the ring holds; a power of two up to 128 */
+#ifndef EDGE_RING_SIZE
+#    define EDGE_RING_SIZE 64
+#endif
+
+/* Edges one key can hold while the ring is full; even */
+#ifndef EDGE_RING_KEY_BACKLOG
+#    define EDGE_RING_KEY_BACKLOG 4
+#endif
+
+/* Interrupt time per tick after which the remaining rows wait for the next tick */
+#ifndef EDGE_RING_TICK_BUDGET_US
+#    define EDGE_RING_TICK_BUDGET_US 50
+#endif
+
+/* QMK's debounce time, as its debounce algorithms default it */
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+/* Upper bound on the wait for the columns to recover after a row with pressed keys */
+#ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#endif
+
+typedef struct {
+    uint32_t scan_hz;    /* full matrix scans per second */
+    uint32_t overflows;  /* ticks that found the ring full */
+    uint32_t lost;       /* edges dropped from a full key backlog, in pairs */
+    uint32_t max_lag_us; /* longest an edge waited in the ring */
+    uint8_t  high_water; /* most edges queued at once */
+} edge_ring_stats_t;
+
+/* Backdates a matrix event to its edge; called from pre_process_record_user */
+void edge_ring_record(keyrecord_t *record);
+
+const edge_ring_stats_t *edge_ring_stats(void);
+
+/* Raw HID reply: scan_hz, overflows, max_lag_us (u32 each), ring size, high water, lost (u32) */
+void edge_ring_hid(uint8_t *data, uint8_t length);
@@ -0,0 +1,47 @@
+#include "hand_resolution.h"
+
+#ifdef KEYTIME_ENABLE
+#    include "keytime.h"
+#endif
+#ifdef TYPING_SPEED_ENABLE
+#    include "typing_speed.h"
+#endif
+
+static keypos_t dance_keys[HAND_RESOLUTION_MAX_DANCES];
+static keypos_t interrupt_key;
+
+void hand_resolution_record(uint16_t keycode, keyrecord_t *record) {
+    if (!IS_EVENT(record->event) || !record->event.pressed) {
+        return;
+    }
+    if (IS_QK_TAP_DANCE(keycode) && QK_TAP_DANCE_GET_INDEX(keycode) < HAND_RESOLUTION_MAX_DANCES) {
+        dance_keys[QK_TAP_DANCE_GET_INDEX(keycode)] = record->event.key;
+    }
+    /* Tap dance finishes an interrupted dance while handling this press */
+    interrupt_key = record->event.key;
+}
+
+bool hand_resolution_opposite_hold(keypos_t tap_hold_key, keypos_t other_key) {
+    if (OLKB_SAME_HAND(tap_hold_key.row, other_key.row)) {
+        return false;
+    }
+#ifdef TYPING_SPEED_ENABLE
+    /* Cross-hand interrupts during a typing burst are rolls */
+    if (typing_speed_in_burst()) {
+        return false;
+    }
+#endif
+#if defined(KEYTIME_ENABLE) && HAND_RESOLUTION_MIN_OVERLAP_US > 0
+    /* Near-simultaneous cross-hand presses are rolls, not chords */
+    return keytime_delta_us(tap_hold_key, other_key) >= HAND_RESOLUTION_MIN_OVERLAP_US;
+#else
+    return true;
+#endif
+}
+
+bool hand_resolution_dance_hold(uint8_t index, tap_dance_state_t *state) {
+    if (state->count != 1 || !state->interrupted || !state->pressed || index >= HAND_RESOLUTION_MAX_DANCES) {
+        return false;
+    }
+    return hand_resolution_opposite_hold(dance_keys[index], interrupt_key);
+}
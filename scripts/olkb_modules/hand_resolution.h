@@ -0,0 +1,35 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Planck Rev6 folded matrix: rows 0-3 are the left hand, rows 4-7 the right.
+ * Bit 2 of the row index is therefore the hand, so one XOR decides it.
+ */
+#define OLKB_IS_LEFT_HAND(row) (((row) & 0x04) == 0)
+#define OLKB_SAME_HAND(row_a, row_b) ((((row_a) ^ (row_b)) & 0x04) == 0)
+
+#ifndef HAND_RESOLUTION_MAX_DANCES
+#    define HAND_RESOLUTION_MAX_DANCES 32
+#endif
+
+/*
+ * With KEYTIME_ENABLE, an opposite-hand press landing less than this many
+ * microseconds after the tap-hold key is treated as a roll (tap). 0 = off.
+ */
+#ifndef HAND_RESOLUTION_MIN_OVERLAP_US
+#    define HAND_RESOLUTION_MIN_OVERLAP_US 0
+#endif
+
+/* Called from pre_process_record_user before tapping and tap dance see the event */
+void hand_resolution_record(uint16_t keycode, keyrecord_t *record);
+
+/* True when `other_key` interrupting `tap_hold_key` should settle it as a hold */
+bool hand_resolution_opposite_hold(keypos_t tap_hold_key, keypos_t other_key);
+
+/*
+ * True when an interrupted single tap of dance `index` should resolve as a
+ * hold instead: the interrupting key is on the opposite hand and the dance
+ * key is still down.
+ */
+bool hand_resolution_dance_hold(uint8_t index, tap_dance_state_t *state);
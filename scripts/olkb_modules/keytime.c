@@ -0,0 +1,72 @@
+#include "keytime.h"
+
+#ifdef PROTOCOL_CHIBIOS
+#    include <hal.h>
+
+#    define KEYTIME_CYCLES_PER_US (STM32_SYSCLK / 1000000U)
+
+static uint32_t last_cycles;
+static uint32_t cycle_remainder;
+#endif
+
+static uint32_t now_us;
+static uint32_t edge_us[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t previous[MATRIX_ROWS];
+
+void keytime_init(void) {
+#ifdef PROTOCOL_CHIBIOS
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    last_cycles = 0;
+    cycle_remainder = 0;
+#endif
+    now_us = 0;
+}
+
+uint32_t keytime_now_us(void) {
+#ifdef PROTOCOL_CHIBIOS
+    /* Fold elapsed cycles into a microsecond counter that wraps at 2^32 us
+       rather than at 2^32 cycles (~60 s at 72 MHz) */
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t delta  = cycles - last_cycles + cycle_remainder;
+    last_cycles     = cycles;
+    now_us += delta / KEYTIME_CYCLES_PER_US;
+    cycle_remainder = delta % KEYTIME_CYCLES_PER_US;
+#else
+    now_us = timer_read32() * 1000U;
+#endif
+    return now_us;
+}
+
+void keytime_scan(void) {
+    /* Read the clock on every scan, changed or not, so the cycle counter is
+       folded in well before it wraps */
+    uint32_t now = keytime_now_us();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t current = matrix_get_row(row);
+        matrix_row_t changed = current ^ previous[row];
+        if (!changed) {
+            continue;
+        }
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (changed & ((matrix_row_t)1 << col)) {
+                edge_us[row][col] = now;
+            }
+        }
+        previous[row] = current;
+    }
+}
+
+uint32_t keytime_edge_us(keypos_t key) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return 0;
+    }
+    return edge_us[key.row][key.col];
+}
+
+uint32_t keytime_delta_us(keypos_t first, keypos_t second) {
+    uint32_t delta = keytime_edge_us(second) - keytime_edge_us(first);
+    /* Treat a wrapped (negative) difference as "second came first" */
+    return delta > 0x80000000U ? 0 : delta;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Microsecond key event timestamps.
+ * On ChibiOS the Cortex-M4 DWT cycle counter is the time base (TIM2, the
+ * F303's only 32-bit general purpose timer, is the ChibiOS system tick), so
+ * stamps are cycle-accurate instead of quantised to timer_read()'s 1 ms.
+ * The microsecond clock wraps after ~71.6 minutes; compare stamps with
+ * unsigned subtraction.
+ */
+
+/* Start the time base; called from keyboard_pre_init_user */
+void keytime_init(void);
+
+/* Free-running microsecond clock. Call at least once a minute; keytime_scan() calls it on every scan. */
+uint32_t keytime_now_us(void);
+
+/* Stamp every matrix edge since the last call; called from matrix_scan_user */
+void keytime_scan(void);
+
+/* Time of the last press/release edge seen at `key` */
+uint32_t keytime_edge_us(keypos_t key);
+
+/* Microseconds between the last edges of `first` and `second` (0 if `second` came first) */
+uint32_t keytime_delta_us(keypos_t first, keypos_t second);
@@ -0,0 +1,147 @@
+#include "kinetic_mouse.h"
+#include <hal.h>
+
+enum {
+    DIR_UP    = 1 << 0,
+    DIR_DOWN  = 1 << 1,
+    DIR_LEFT  = 1 << 2,
+    DIR_RIGHT = 1 << 3,
+};
+
+/* 1/sqrt(2) in Q8 for diagonal movement */
+#define KINETIC_MOUSE_DIAGONAL 181
+
+static const kinetic_profile_t profiles[] = KINETIC_MOUSE_PROFILES;
+
+static virtual_timer_t integrator;
+/* Integration step: the timer period, rounded to whole system ticks */
+static uint32_t tick_us;
+
+/* Shared with the timer callback; the main loop changes them with the kernel locked */
+static volatile uint8_t directions;
+static uint32_t         speed;
+static int32_t          pending_x; /* Q16.16 pixels integrated but not sent yet */
+static int32_t          pending_y;
+
+static const kinetic_profile_t *kinetic_mouse_profile(void) {
+    uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+    uint8_t count = sizeof(profiles) / sizeof(profiles[0]);
+    return &profiles[layer < count ? layer : count - 1];
+}
+
+static uint8_t kinetic_mouse_direction(uint16_t keycode) {
+    switch (keycode) {
+        case QK_MOUSE_CURSOR_UP:
+            return DIR_UP;
+        case QK_MOUSE_CURSOR_DOWN:
+            return DIR_DOWN;
+        case QK_MOUSE_CURSOR_LEFT:
+            return DIR_LEFT;
+        case QK_MOUSE_CURSOR_RIGHT:
+            return DIR_RIGHT;
+    }
+    return 0;
+}
+
+static void kinetic_mouse_add(int32_t *pending, int32_t step) {
+    const int32_t limit = KINETIC_MOUSE_MAX_BACKLOG * 65536;
+    *pending += step;
+    if (*pending > limit) {
+        *pending = limit;
+    } else if (*pending < -limit) {
+        *pending = -limit;
+    }
+}
+
+/* One tick_us step of speed and distance; called with the kernel locked */
+static void kinetic_mouse_integrate(void) {
+    const kinetic_profile_t *profile = kinetic_mouse_profile();
+    /* 64-bit products: a Q16.16 speed times microseconds overflows 32 bits for fast profiles */
+    uint64_t accelerated = speed + (uint64_t)profile->accel * tick_us / 1000U;
+    speed                = accelerated > profile->max ? profile->max : accelerated;
+
+    /* Q16.16 sub-pixels travelled this step */
+    int32_t step = (uint64_t)speed * tick_us / 1000U;
+    int8_t  dx   = ((directions & DIR_RIGHT) ? 1 : 0) - ((directions & DIR_LEFT) ? 1 : 0);
+    int8_t  dy   = ((directions & DIR_DOWN) ? 1 : 0) - ((directions & DIR_UP) ? 1 : 0);
+    if (dx && dy) {
+        step = (int64_t)step * KINETIC_MOUSE_DIAGONAL / 256;
+    }
+    kinetic_mouse_add(&pending_x, dx * step);
+    kinetic_mouse_add(&pending_y, dy * step);
+}
+
+static void kinetic_mouse_tick(virtual_timer_t *vtp, void *param) {
+    (void)vtp;
+    (void)param;
+    if (directions) {
+        kinetic_mouse_integrate();
+    }
+}
+
+bool kinetic_mouse_process(uint16_t keycode, keyrecord_t *record) {
+    uint8_t direction = kinetic_mouse_direction(keycode);
+    if (!direction) {
+        return true;
+    }
+    if (record->event.pressed) {
+        bool starting = !directions;
+        chSysLock();
+        if (starting) {
+            speed     = kinetic_mouse_profile()->start;
+            pending_x = 0;
+            pending_y = 0;
+        }
+        directions |= direction;
+        if (starting) {
+            /* Move on the press itself rather than one period later */
+            kinetic_mouse_integrate();
+        }
+        chSysUnlock();
+        if (starting) {
+            if (!tick_us) {
+                chVTObjectInit(&integrator);
+                tick_us = TIME_I2US(TIME_US2I(KINETIC_MOUSE_INTERVAL_US));
+            }
+            chVTSetContinuous(&integrator, TIME_US2I(KINETIC_MOUSE_INTERVAL_US), kinetic_mouse_tick, NULL);
+        }
+    } else {
+        chSysLock();
+        directions &= ~direction;
+        chSysUnlock();
+        if (!directions) {
+            /* Whatever was integrated still goes out from the task */
+            chVTReset(&integrator);
+        }
+    }
+    return false;
+}
+
+static int8_t kinetic_mouse_take(int32_t *pending) {
+    int32_t pixels = *pending / 65536;
+    if (pixels > 127) {
+        pixels = 127;
+    } else if (pixels < -127) {
+        pixels = -127;
+    }
+    *pending -= pixels * 65536;
+    return pixels;
+}
+
+void kinetic_mouse_task(void) {
+    chSysLock();
+    int8_t x = kinetic_mouse_take(&pending_x);
+    int8_t y = kinetic_mouse_take(&pending_y);
+    chSysUnlock();
+    if (!x && !y) {
+        return;
+    }
+
+    report_mouse_t report = mousekey_get_report();
+    report.x              = x;
+    report.y              = y;
+    /* Wheel motion belongs to mousekey's own reports */
+    report.v = 0;
+    report.h = 0;
+    host_mouse_send(&report);
+}
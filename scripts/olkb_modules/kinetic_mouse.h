@@ -0,0 +1,47 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Kinetic mouse-key cursor movement integrated in fixed point at the USB
+ * polling rate. Speed is kept in Q16.16 pixels per millisecond and the
+ * sub-pixel remainder carries over between reports, so slow movement is
+ * smooth instead of snapping to MOUSEKEY_INTERVAL steps. Buttons and the
+ * wheel stay with QMK's mousekey code.
+ *
+ * A ChibiOS virtual timer integrates every KINETIC_MOUSE_INTERVAL_US from the
+ * system tick, so speed and distance follow real time even while a hook
+ * blocks the main loop. Housekeeping only sends what has been integrated,
+ * at most one report per timer step.
+ */
+
+typedef struct {
+    uint32_t start; /* Q16.16 px/ms when a direction key goes down */
+    uint32_t max;   /* Q16.16 px/ms cap */
+    uint32_t accel; /* Q16.16 px/ms per ms */
+} kinetic_profile_t;
+
+/* Profile from human units: px/s, px/s, px/s^2 */
+#define KINETIC_PROFILE(start_px_s, max_px_s, accel_px_s2) \
+    { (uint32_t)((uint64_t)(start_px_s) * 65536U / 1000U), (uint32_t)((uint64_t)(max_px_s) * 65536U / 1000U), (uint32_t)((uint64_t)(accel_px_s2) * 65536U / 1000000U) }
+
+/* Per-layer profiles indexed by the highest active layer; higher layers use the last one */
+#ifndef KINETIC_MOUSE_PROFILES
+#    define KINETIC_MOUSE_PROFILES { KINETIC_PROFILE(200, 2400, 4000) }
+#endif
+
+/* Integration and report interval, rounded to whole system ticks: 1000 us matches a 1 kHz USB polling rate */
+#ifndef KINETIC_MOUSE_INTERVAL_US
+#    define KINETIC_MOUSE_INTERVAL_US 1000
+#endif
+
+/* Most pixels per axis left waiting for a blocked main loop; more is dropped so the cursor cannot fling */
+#ifndef KINETIC_MOUSE_MAX_BACKLOG
+#    define KINETIC_MOUSE_MAX_BACKLOG 508
+#endif
+
+/* Called from process_record_user; returns false for the cursor keys it owns */
+bool kinetic_mouse_process(uint16_t keycode, keyrecord_t *record);
+
+/* Sends the movement the timer has integrated; called from housekeeping */
+void kinetic_mouse_task(void);
@@ -0,0 +1,83 @@
+#include "olkb_hid.h"
+
+#ifdef BOOT_PROFILE_ENABLE
+#    include "boot_profile.h"
+#endif
+#ifdef ADAPTIVE_DEBOUNCE_ENABLE
+#    include "adaptive_debounce.h"
+#endif
+#ifdef BULK_KEYMAP_ENABLE
+#    include "bulk_keymap.h"
+#endif
+#ifdef DMA_MATRIX_ENABLE
+#    include "dma_matrix.h"
+#endif
+#ifdef USB_STATS_ENABLE
+#    include "usb_stats.h"
+#endif
+#ifdef SETTLE_CALIBRATION_ENABLE
+#    include "settle_calibration.h"
+#endif
+#ifdef EDGE_RING_ENABLE
+#    include "edge_ring.h"
+#endif
+
+#ifdef VIA_ENABLE
+bool via_command_kb(uint8_t *data, uint8_t length) {
+    if (data[0] != OLKB_HID_COMMAND) {
+        return false;
+    }
+    bool reply = true;
+    switch (data[1]) {
+#    ifdef BOOT_PROFILE_ENABLE
+        case OLKB_HID_BOOT_PROFILE:
+            boot_profile_hid(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef ADAPTIVE_DEBOUNCE_ENABLE
+        case OLKB_HID_DEBOUNCE:
+            adaptive_debounce_hid(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef BULK_KEYMAP_ENABLE
+        case OLKB_HID_BULK_BEGIN:
+            reply = bulk_keymap_begin(&data[2], length - 2);
+            break;
+        case OLKB_HID_BULK_DATA:
+            /* Streamed without replies so the host never waits per report */
+            reply = bulk_keymap_data(&data[2], length - 2);
+            break;
+        case OLKB_HID_BULK_END:
+            reply = bulk_keymap_end(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef DMA_MATRIX_ENABLE
+        case OLKB_HID_DMA_MATRIX:
+            dma_matrix_hid(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef USB_STATS_ENABLE
+        case OLKB_HID_USB_STATS:
+            usb_stats_hid(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef SETTLE_CALIBRATION_ENABLE
+        case OLKB_HID_SETTLE_CALIBRATION:
+            settle_calibration_hid(&data[2], length - 2);
+            break;
+#    endif
+#    ifdef EDGE_RING_ENABLE
+        case OLKB_HID_EDGE_RING:
+            edge_ring_hid(&data[2], length - 2);
+            break;
+#    endif
+        default:
+            data[0] = OLKB_HID_UNHANDLED;
+            break;
+    }
+    if (reply) {
+        raw_hid_send(data, length);
+    }
+    return true;
+}
+#endif
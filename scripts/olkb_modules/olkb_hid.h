@@ -0,0 +1,38 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Raw HID channel for the converter modules, multiplexed into VIA/Vial's
+ * protocol through via_command_kb(). Requests and responses are one
+ * RAW_EPSIZE report: [OLKB_HID_COMMAND, subcommand, payload...].
+ * Multi-byte values are big-endian, like VIA's.
+ */
+#define OLKB_HID_COMMAND 0xB0
+
+enum olkb_hid_subcommand {
+    OLKB_HID_BOOT_PROFILE       = 0x01,
+    OLKB_HID_DEBOUNCE           = 0x02,
+    OLKB_HID_BULK_BEGIN         = 0x03,
+    OLKB_HID_BULK_DATA          = 0x04,
+    OLKB_HID_BULK_END           = 0x05,
+    OLKB_HID_DMA_MATRIX         = 0x06,
+    OLKB_HID_USB_STATS          = 0x07,
+    OLKB_HID_SETTLE_CALIBRATION = 0x08,
+    OLKB_HID_EDGE_RING          = 0x09,
+};
+
+/* Response status written to data[0] when a subcommand is not built in */
+#define OLKB_HID_UNHANDLED 0xFF
+
+static inline void olkb_hid_put_u16(uint8_t *data, uint16_t value) {
+    data[0] = value >> 8;
+    data[1] = value & 0xFF;
+}
+
+static inline void olkb_hid_put_u32(uint8_t *data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = (value >> 16) & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
+}
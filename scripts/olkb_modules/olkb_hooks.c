@@ -0,0 +1,245 @@
+/*
+ * Hook dispatcher for the converted Planck Rev6 keymap.
+ * Generated keymap folders always build this file; each optional module is
+ * switched by its *_ENABLE flag in rules.mk.
+ */
+#include "olkb_hooks.h"
+
+#ifdef KEYTIME_ENABLE
+#    include "keytime.h"
+#endif
+#ifdef HAND_RESOLUTION_ENABLE
+#    include "hand_resolution.h"
+#endif
+#ifdef BOOT_PROFILE_ENABLE
+#    include "boot_profile.h"
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+#    include "text_expansion.h"
+#endif
+#ifdef EAGER_MODS_ENABLE
+#    include "eager_mods.h"
+#endif
+#ifdef TYPING_SPEED_ENABLE
+#    include "typing_speed.h"
+#endif
+#ifdef KINETIC_MOUSE_ENABLE
+#    include "kinetic_mouse.h"
+#endif
+#ifdef DANCE_ENGINE_ENABLE
+#    include "dance_engine.h"
+#endif
+#ifdef USB_STATS_ENABLE
+#    include "usb_stats.h"
+#endif
+#ifdef SETTLE_CALIBRATION_ENABLE
+#    include "settle_calibration.h"
+#endif
+#ifdef EDGE_RING_ENABLE
+#    include "edge_ring.h"
+#endif
+
+/* Defaults for hooks the Oryx export did not define */
+__attribute__((weak)) void keyboard_pre_init_oryx(void) {}
+
+__attribute__((weak)) void matrix_init_oryx(void) {}
+
+__attribute__((weak)) void keyboard_post_init_oryx(void) {}
+
+__attribute__((weak)) void matrix_scan_oryx(void) {}
+
+__attribute__((weak)) void housekeeping_task_oryx(void) {}
+
+__attribute__((weak)) bool pre_process_record_oryx(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) bool process_record_oryx(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) void post_process_record_oryx(uint16_t keycode, keyrecord_t *record) {}
+
+__attribute__((weak)) bool get_hold_on_other_key_press_oryx(uint16_t keycode, keyrecord_t *record) {
+    return false;
+}
+
+__attribute__((weak)) uint16_t get_tapping_term_oryx(uint16_t keycode, keyrecord_t *record) {
+    return TAPPING_TERM;
+}
+
+static bool first_scan_done;
+static bool lazy_init_done;
+
+/*
+ * Non-essential work that would otherwise delay the first keystroke.
+ * Runs once from housekeeping after the first matrix scan.
+ */
+static void olkb_lazy_init(void) {
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_mark(BOOT_PHASE_LAZY_INIT);
+#endif
+#if defined(AUDIO_ENABLE) && defined(OLKB_LAZY_STARTUP_SONG)
+    static float startup_song[][2] = OLKB_LAZY_STARTUP_SONG;
+    PLAY_SONG(startup_song);
+#endif
+}
+
+void keyboard_pre_init_user(void) {
+#ifdef KEYTIME_ENABLE
+    keytime_init();
+#endif
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_mark(BOOT_PHASE_PRE_INIT);
+#endif
+    keyboard_pre_init_oryx();
+}
+
+void matrix_init_user(void) {
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_mark(BOOT_PHASE_MATRIX_INIT);
+#endif
+#ifdef SETTLE_CALIBRATION_ENABLE
+    settle_calibration_init();
+#endif
+    matrix_init_oryx();
+}
+
+void keyboard_post_init_user(void) {
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_mark(BOOT_PHASE_POST_INIT);
+#endif
+    keyboard_post_init_oryx();
+}
+
+void matrix_scan_user(void) {
+#ifdef KEYTIME_ENABLE
+    keytime_scan();
+#endif
+#ifdef SETTLE_CALIBRATION_ENABLE
+    settle_calibration_scan();
+#endif
+    if (!first_scan_done) {
+        first_scan_done = true;
+#ifdef BOOT_PROFILE_ENABLE
+        boot_profile_mark(BOOT_PHASE_FIRST_SCAN);
+#endif
+    }
+    matrix_scan_oryx();
+}
+
+void housekeeping_task_user(void) {
+    if (first_scan_done && !lazy_init_done) {
+        lazy_init_done = true;
+        olkb_lazy_init();
+    }
+#ifdef TEXT_EXPANSION_ENABLE
+    text_expansion_task();
+#endif
+#ifdef KINETIC_MOUSE_ENABLE
+    kinetic_mouse_task();
+#endif
+#ifdef DANCE_ENGINE_ENABLE
+    dance_engine_task();
+#endif
+#ifdef USB_STATS_ENABLE
+    usb_stats_task();
+#endif
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_task();
+#endif
+    housekeeping_task_oryx();
+}
+
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+#ifdef EDGE_RING_ENABLE
+    /* First, so every module below sees the edge's own time */
+    edge_ring_record(record);
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+    text_expansion_flush(record);
+#endif
+#ifdef TYPING_SPEED_ENABLE
+    typing_speed_record(record);
+#endif
+#ifdef HAND_RESOLUTION_ENABLE
+    hand_resolution_record(keycode, record);
+#endif
+#ifdef EAGER_MODS_ENABLE
+    eager_mods_record(keycode, record);
+#endif
+#ifdef DANCE_ENGINE_ENABLE
+    if (!dance_engine_record(keycode, record)) {
+        return false;
+    }
+#endif
+    return pre_process_record_oryx(keycode, record);
+}
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+#ifdef TEXT_EXPANSION_ENABLE
+    /* Again for events the tapping buffer held back past a trigger */
+    text_expansion_flush(record);
+#endif
+#ifdef EAGER_MODS_ENABLE
+    eager_mods_process(keycode, record);
+#endif
+#ifdef DANCE_ENGINE_ENABLE
+    dance_engine_process(keycode, record);
+#endif
+#ifdef TEXT_EXPANSION_ENABLE
+    if (!text_expansion_process(keycode, record)) {
+        return false;
+    }
+#endif
+#ifdef KINETIC_MOUSE_ENABLE
+    if (!kinetic_mouse_process(keycode, record)) {
+        return false;
+    }
+#endif
+    return process_record_oryx(keycode, record);
+}
+
+void post_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    post_process_record_oryx(keycode, record);
+}
+
+#ifdef HAND_RESOLUTION_ENABLE
+char chordal_hold_handedness(keypos_t key) {
+    return OLKB_IS_LEFT_HAND(key.row) ? 'L' : 'R';
+}
+
+bool get_chordal_hold(uint16_t tap_hold_keycode, keyrecord_t *tap_hold_record, uint16_t other_keycode, keyrecord_t *other_record) {
+    return hand_resolution_opposite_hold(tap_hold_record->event.key, other_record->event.key);
+}
+#endif
+
+#if defined(HAND_RESOLUTION_ENABLE) || defined(OLKB_ORYX_HOLD_ON_OTHER_KEY_PRESS)
+bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record) {
+#    ifdef HAND_RESOLUTION_ENABLE
+    /* Same-hand presses were already settled as taps by get_chordal_hold */
+    if (IS_QK_MOD_TAP(keycode)) {
+        return true;
+    }
+#    endif
+    return get_hold_on_other_key_press_oryx(keycode, record);
+}
+#endif
+
+#if defined(TYPING_SPEED_ENABLE) || defined(OLKB_PROFILE_COUNT) || defined(OLKB_ORYX_TAPPING_TERM)
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+#    ifdef TYPING_SPEED_ENABLE
+    return typing_speed_tapping_term(get_tapping_term_oryx(keycode, record));
+#    else
+    /* The export's per-key terms, or each profile's own term */
+    return get_tapping_term_oryx(keycode, record);
+#    endif
+}
+#endif
+
+#ifdef TYPING_SPEED_ENABLE
+uint16_t get_flow_tap_term(uint16_t keycode, keyrecord_t *record, uint16_t prev_keycode) {
+    /* Inside a burst any recent key settles the mod-tap as a tap at once */
+    return typing_speed_in_burst() ? TYPING_SPEED_IDLE_MS : 0;
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * QMK user hooks owned by olkb_hooks.c.
+ * oryx_to_olkb.py renames any of these defined by the Oryx export to the
+ * matching *_oryx name, so the export keeps working behind the module chain.
+ */
+void keyboard_pre_init_oryx(void);
+void matrix_init_oryx(void);
+void keyboard_post_init_oryx(void);
+void matrix_scan_oryx(void);
+void housekeeping_task_oryx(void);
+bool pre_process_record_oryx(uint16_t keycode, keyrecord_t *record);
+bool process_record_oryx(uint16_t keycode, keyrecord_t *record);
+void post_process_record_oryx(uint16_t keycode, keyrecord_t *record);
+bool get_hold_on_other_key_press_oryx(uint16_t keycode, keyrecord_t *record);
+uint16_t get_tapping_term_oryx(uint16_t keycode, keyrecord_t *record);
@@ -0,0 +1,129 @@
+#include "settle_calibration.h"
+#include "olkb_hid.h"
+#include <hal.h>
+
+#define CYCLES_PER_US (STM32_SYSCLK / 1000000U)
+#define STOCK_CYCLES (MATRIX_IO_DELAY * CYCLES_PER_US)
+
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+/* Until calibration has run every row gets the stock wait */
+static uint32_t bound_cycles[MATRIX_ROWS] = {[0 ... MATRIX_ROWS - 1] = STOCK_CYCLES};
+
+static settle_calibration_stats_t stats;
+static uint32_t                   window_start;
+static uint32_t                   window_scans;
+static uint32_t                   window_settle_cycles;
+
+static uint32_t cycles_to_ns(uint64_t cycles) {
+    return cycles * 1000U / CYCLES_PER_US;
+}
+
+/* Slowest rise from low to a high read through the line's pull-up; capped at the stock delay */
+static uint32_t rise_cycles(pin_t pin) {
+    uint32_t worst = 0;
+    for (uint8_t trial = 0; trial < SETTLE_CALIBRATION_TRIALS; trial++) {
+        gpio_set_pin_output(pin);
+        gpio_write_pin_low(pin);
+        wait_us(1);
+
+        uint32_t elapsed;
+        chSysLock();
+        gpio_set_pin_input_high(pin);
+        uint32_t started = DWT->CYCCNT;
+        do {
+            elapsed = DWT->CYCCNT - started;
+        } while (!gpio_read_pin(pin) && elapsed < STOCK_CYCLES);
+        chSysUnlock();
+
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+    }
+    return worst;
+}
+
+void settle_calibration_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* Column lines are shared by every row, so the slowest one counts for all */
+    uint32_t columns = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        uint32_t rise = rise_cycles(col_pins[col]);
+        if (rise > columns) {
+            columns = rise;
+        }
+    }
+
+    uint32_t floor_cycles = SETTLE_CALIBRATION_FLOOR_NS * CYCLES_PER_US / 1000U;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        uint32_t rise  = rise_cycles(row_pins[row]);
+        uint32_t worst = rise > columns ? rise : columns;
+        uint32_t bound = worst + worst * SETTLE_CALIBRATION_MARGIN_PERCENT / 100U;
+        if (bound < floor_cycles) {
+            bound = floor_cycles;
+        }
+        if (worst >= STOCK_CYCLES || bound > STOCK_CYCLES) {
+            bound = STOCK_CYCLES;
+            stats.fallback_rows |= 1U << row;
+        }
+        bound_cycles[row]   = bound;
+        stats.bound_ns[row] = cycles_to_ns(bound);
+    }
+    window_start = timer_read32();
+}
+
+static bool lines_high(uint8_t row) {
+    if (!gpio_read_pin(row_pins[row])) {
+        return false;
+    }
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!gpio_read_pin(col_pins[col])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Replaces QMK's fixed MATRIX_IO_DELAY wait after each row is read */
+void matrix_output_unselect_delay(uint8_t line, bool key_pressed) {
+    uint32_t started = DWT->CYCCNT;
+    uint32_t elapsed;
+    do {
+        elapsed = DWT->CYCCNT - started;
+    } while (!lines_high(line) && elapsed < bound_cycles[line]);
+    window_settle_cycles += elapsed;
+}
+
+void settle_calibration_scan(void) {
+    window_scans++;
+    uint32_t elapsed = timer_elapsed32(window_start);
+    if (elapsed < 1000) {
+        return;
+    }
+    stats.scan_hz        = window_scans * 1000U / elapsed;
+    stats.settle_ns      = cycles_to_ns(window_settle_cycles) / window_scans;
+    window_start         = timer_read32();
+    window_scans         = 0;
+    window_settle_cycles = 0;
+}
+
+const settle_calibration_stats_t *settle_calibration_stats(void) {
+    return &stats;
+}
+
+void settle_calibration_hid(uint8_t *data, uint8_t length) {
+    if (length < 14 + MATRIX_ROWS * 2) {
+        return;
+    }
+    olkb_hid_put_u32(&data[0], stats.scan_hz);
+    olkb_hid_put_u32(&data[4], stats.settle_ns);
+    olkb_hid_put_u32(&data[8], MATRIX_ROWS * MATRIX_IO_DELAY * 1000U);
+    data[12] = MATRIX_ROWS;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        olkb_hid_put_u16(&data[13 + row * 2], stats.bound_ns[row]);
+    }
+    data[13 + MATRIX_ROWS * 2] = stats.fallback_rows;
+}
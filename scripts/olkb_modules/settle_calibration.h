@@ -0,0 +1,57 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Calibrated row unselect delay for QMK's stock matrix scanner. QMK waits
+ * MATRIX_IO_DELAY (30 us) after every row, so the Rev6's eight rows spend
+ * about 240 us per scan just waiting. At boot this module measures how long
+ * each row line and each column line takes to rise through its pull-up.
+ * Each row then gets a bound: the slowest of its own line and the columns,
+ * plus SETTLE_CALIBRATION_MARGIN_PERCENT, and never less than
+ * SETTLE_CALIBRATION_FLOOR_NS. After a row is read,
+ * matrix_output_unselect_delay() polls until the row and every column read
+ * high again. It stops early when they do and never waits past that row's
+ * bound. A line that does not rise within MATRIX_IO_DELAY keeps the stock wait.
+ */
+#ifdef DMA_MATRIX_ENABLE
+#    error "SETTLE_CALIBRATION_ENABLE tunes the stock scanner, which DMA_MATRIX_ENABLE replaces; enable only one"
+#endif
+
+#ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#endif
+
+/* Rise-time measurements per line; the slowest is kept */
+#ifndef SETTLE_CALIBRATION_TRIALS
+#    define SETTLE_CALIBRATION_TRIALS 16
+#endif
+
+/* Headroom added to the measured rise time */
+#ifndef SETTLE_CALIBRATION_MARGIN_PERCENT
+#    define SETTLE_CALIBRATION_MARGIN_PERCENT 50
+#endif
+
+/* Lower limit of a row's bound, covering the GPIO input synchroniser */
+#ifndef SETTLE_CALIBRATION_FLOOR_NS
+#    define SETTLE_CALIBRATION_FLOOR_NS 250
+#endif
+
+typedef struct {
+    uint32_t scan_hz;               /* matrix scans per second */
+    uint32_t settle_ns;             /* average time spent in unselect delays per scan */
+    uint16_t bound_ns[MATRIX_ROWS]; /* per-row settle bound from calibration */
+    uint8_t  fallback_rows;         /* rows left at MATRIX_IO_DELAY, one bit each */
+} settle_calibration_stats_t;
+
+/* Measures the lines; called from matrix_init_user once the pins are set up */
+void settle_calibration_init(void);
+
+/* Counts scans and the time spent settling; called from matrix_scan_user */
+void settle_calibration_scan(void);
+
+const settle_calibration_stats_t *settle_calibration_stats(void);
+
+/* Raw HID reply: scan_hz, settle_ns, stock ns per scan (u32 each), row
+   count, bound_ns per row (u16 each), fallback row mask */
+void settle_calibration_hid(uint8_t *data, uint8_t length);
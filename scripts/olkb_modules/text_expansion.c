@@ -0,0 +1,99 @@
+#include "text_expansion.h"
+#include "text_expansion_data.h"
+
+#define TEXT_EXPANSION_NO_SYMBOL 0xFF
+
+static text_expansion_state_t state;
+
+/* Pending output: backspaces first, then the expansion text */
+static uint8_t     pending_backspaces;
+static const char *pending_text;
+
+/* Keycode to automaton symbol; order matches TEXT_EXPANSION_ALPHABET in oryx_to_olkb.py */
+static uint8_t text_expansion_symbol(uint16_t keycode) {
+    if (keycode >= KC_A && keycode <= KC_Z) {
+        return keycode - KC_A;
+    }
+    if (keycode >= KC_1 && keycode <= KC_0) {
+        return 26 + (keycode - KC_1);
+    }
+    switch (keycode) {
+        case KC_SCLN:
+            return 36;
+        case KC_COMMA:
+            return 37;
+        case KC_DOT:
+            return 38;
+    }
+    return TEXT_EXPANSION_NO_SYMBOL;
+}
+
+/* Sends one pending keystroke; false once nothing is left */
+static bool text_expansion_step(void) {
+    if (pending_backspaces) {
+        pending_backspaces--;
+        tap_code(KC_BSPC);
+        return true;
+    }
+    if (!pending_text) {
+        return false;
+    }
+    char next = pgm_read_byte(pending_text);
+    if (!next) {
+        pending_text = NULL;
+        return false;
+    }
+    pending_text++;
+    send_char(next);
+    return true;
+}
+
+void text_expansion_flush(keyrecord_t *record) {
+    if (!IS_EVENT(record->event) || !(pending_backspaces || pending_text)) {
+        return;
+    }
+    while (text_expansion_step()) {
+    }
+    state = 0;
+}
+
+bool text_expansion_process(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed) {
+        return true;
+    }
+    if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+        if (record->tap.count == 0) {
+            return true;
+        }
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    uint8_t symbol = text_expansion_symbol(keycode);
+    if (symbol == TEXT_EXPANSION_NO_SYMBOL || (get_mods() & ~MOD_MASK_SHIFT)) {
+        state = 0;
+        return true;
+    }
+
+#if TEXT_EXPANSION_STATES > 0x100
+    state = pgm_read_word(&text_expansion_next[state][symbol]);
+#else
+    state = pgm_read_byte(&text_expansion_next[state][symbol]);
+#endif
+#if TEXT_EXPANSION_COUNT >= 0xFF
+    text_expansion_index_t match = pgm_read_word(&text_expansion_match[state]);
+#else
+    text_expansion_index_t match = pgm_read_byte(&text_expansion_match[state]);
+#endif
+    if (!match) {
+        return true;
+    }
+
+    /* The last trigger character has not been sent yet, so it needs no backspace */
+    pending_backspaces = pgm_read_byte(&text_expansion_trigger_length[match - 1]) - 1;
+    pending_text       = (const char *)pgm_read_ptr(&text_expansion_text[match - 1]);
+    state              = 0;
+    return false;
+}
+
+void text_expansion_task(void) {
+    text_expansion_step();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * On-device abbreviation expander.
+ * oryx_to_olkb.py compiles the triggers into a PROGMEM automaton
+ * (text_expansion_data.c): each keystroke is one table lookup, whatever the
+ * dictionary size. A completed trigger is erased and its expansion typed
+ * one character per housekeeping pass, so the scan loop does not block. A key
+ * event that arrives before the expansion is done first sends the rest of it
+ * at once, so typed keys never land inside an expansion.
+ */
+
+/*
+ * Sends what is left of an expansion before any key event (a press, or a held
+ * Shift let go) goes further; called first from pre_process_record_user and
+ * process_record_user, before a module or dance can add a modifier or output
+ * of its own
+ */
+void text_expansion_flush(keyrecord_t *record);
+
+/* Feed a key event; returns false to swallow the trigger's last character */
+bool text_expansion_process(uint16_t keycode, keyrecord_t *record);
+
+/* Sends the next pending character; called from housekeeping_task_user */
+void text_expansion_task(void);
@@ -0,0 +1,57 @@
+#include "typing_speed.h"
+
+static uint16_t last_press;
+static uint16_t average_ms;
+static bool     active;
+static bool     measured; /* average_ms holds at least one interval since the last pause */
+
+static bool typing_speed_idle(void) {
+    return !active || timer_elapsed(last_press) >= TYPING_SPEED_IDLE_MS;
+}
+
+/* The first press after a pause has no interval yet, so it keeps the normal rules */
+static bool typing_speed_settled(void) {
+    return measured && !typing_speed_idle();
+}
+
+void typing_speed_record(keyrecord_t *record) {
+    if (!IS_EVENT(record->event) || !record->event.pressed) {
+        return;
+    }
+    uint16_t now = record->event.time;
+    if (typing_speed_idle()) {
+        measured = false;
+    } else if (!measured) {
+        /* Seed each burst with its first real interval */
+        average_ms = TIMER_DIFF_16(now, last_press);
+        measured   = true;
+    } else {
+        uint16_t interval = TIMER_DIFF_16(now, last_press);
+        /* average += (interval - average) / 4 */
+        average_ms = average_ms + (int16_t)(interval - average_ms) / 4;
+    }
+    last_press = now;
+    active     = true;
+}
+
+bool typing_speed_in_burst(void) {
+    return typing_speed_settled() && average_ms < TYPING_SPEED_BURST_MS;
+}
+
+uint16_t typing_speed_tapping_term(uint16_t base) {
+    if (!typing_speed_settled()) {
+        return base;
+    }
+    uint32_t term = (uint32_t)average_ms * TYPING_SPEED_TERM_FACTOR * base / TAPPING_TERM;
+    if (term < TYPING_SPEED_MIN_TERM(base)) {
+        return TYPING_SPEED_MIN_TERM(base);
+    }
+    if (term > TYPING_SPEED_MAX_TERM(base)) {
+        return TYPING_SPEED_MAX_TERM(base);
+    }
+    return term;
+}
+
+uint16_t typing_speed_average_ms(void) {
+    return typing_speed_settled() ? average_ms : 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Running measure of typing speed: an exponentially weighted average of
+ * the intervals between key presses (one subtract and shift per press).
+ * While typing fast, tap/hold keys lean to tap: the tapping term shrinks,
+ * Flow Tap settles mod-taps as taps at once, and interrupts no longer turn
+ * into holds. After a pause the normal rules apply again, until the
+ * second press gives a real interval to start the average from.
+ */
+
+/* Average press interval below which typing counts as a burst */
+#ifndef TYPING_SPEED_BURST_MS
+#    define TYPING_SPEED_BURST_MS 150
+#endif
+
+/* A gap this long ends the burst; the next interval restarts the average */
+#ifndef TYPING_SPEED_IDLE_MS
+#    define TYPING_SPEED_IDLE_MS 500
+#endif
+
+/*
+ * Effective tapping term is TYPING_SPEED_TERM_FACTOR x the average interval,
+ * scaled by base / TAPPING_TERM so per-key terms keep their ratio, and
+ * clamped to the bounds below, given as functions of base
+ */
+#ifndef TYPING_SPEED_TERM_FACTOR
+#    define TYPING_SPEED_TERM_FACTOR 2
+#endif
+#ifndef TYPING_SPEED_MIN_TERM
+#    define TYPING_SPEED_MIN_TERM(base) ((base) / 2)
+#endif
+#ifndef TYPING_SPEED_MAX_TERM
+#    define TYPING_SPEED_MAX_TERM(base) ((base) + (base) / 4)
+#endif
+
+/* Called from pre_process_record_user for every event */
+void typing_speed_record(keyrecord_t *record);
+
+bool typing_speed_in_burst(void);
+
+/* Scale `base` (the keymap's tapping term) by the current typing speed */
+uint16_t typing_speed_tapping_term(uint16_t base);
+
+/* Average press interval in milliseconds, 0 while idle or before the first interval */
+uint16_t typing_speed_average_ms(void);
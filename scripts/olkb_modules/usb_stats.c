@@ -0,0 +1,157 @@
+#include "usb_stats.h"
+#include "host.h"
+#include "olkb_hid.h"
+
+#ifdef KEYTIME_ENABLE
+#    include "keytime.h"
+#endif
+#ifdef BOOT_PROFILE_ENABLE
+#    include "boot_profile.h"
+#endif
+
+static host_driver_t  counted_driver;
+static host_driver_t *usb_driver;
+static usb_stats_t    stats;
+
+static uint8_t  queue_depth;
+static uint32_t queue_stamp;
+static uint32_t window_start;
+static uint32_t window_reports;
+
+static uint32_t usb_stats_now_us(void) {
+#ifdef KEYTIME_ENABLE
+    return keytime_now_us();
+#else
+    return timer_read32() * 1000U;
+#endif
+}
+
+/* Let the host take one report per polling interval since the last send */
+static void queue_drain(uint32_t now) {
+    uint32_t drained = (now - queue_stamp) / USB_STATS_INTERVAL_US;
+    if (drained >= queue_depth) {
+        queue_depth = 0;
+        queue_stamp = now;
+    } else {
+        queue_depth -= drained;
+        queue_stamp += drained * USB_STATS_INTERVAL_US;
+    }
+}
+
+static uint32_t send_begin(void) {
+    uint32_t now = usb_stats_now_us();
+    queue_drain(now);
+    if (queue_depth < UINT8_MAX) {
+        queue_depth++;
+    }
+    if (queue_depth > stats.queue_high_water) {
+        stats.queue_high_water = queue_depth;
+    }
+    stats.reports++;
+    window_reports++;
+    return now;
+}
+
+static void send_end(uint32_t started) {
+    uint32_t took = usb_stats_now_us() - started;
+    if (took > stats.max_send_us) {
+        stats.max_send_us = took;
+    }
+    if (took >= USB_STATS_DROP_US) {
+        stats.dropped++;
+        /* The report never left, so it is not waiting in the queue either */
+        queue_depth--;
+    } else if (took > USB_STATS_BUSY_US) {
+        stats.busy_waits++;
+    }
+}
+
+static void counted_send_keyboard(report_keyboard_t *report) {
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_keyboard_report(report);
+#endif
+    uint32_t started = send_begin();
+    usb_driver->send_keyboard(report);
+    send_end(started);
+}
+
+static void counted_send_nkro(report_nkro_t *report) {
+#ifdef BOOT_PROFILE_ENABLE
+    boot_profile_nkro_report(report);
+#endif
+    uint32_t started = send_begin();
+    usb_driver->send_nkro(report);
+    send_end(started);
+}
+
+static void counted_send_mouse(report_mouse_t *report) {
+    uint32_t started = send_begin();
+    usb_driver->send_mouse(report);
+    send_end(started);
+}
+
+static void counted_send_extra(report_extra_t *report) {
+    uint32_t started = send_begin();
+    usb_driver->send_extra(report);
+    send_end(started);
+}
+
+/*
+ * The USB driver is installed after keyboard_post_init_user, so wrap it from
+ * housekeeping. Fields other than the report senders are copied unchanged.
+ */
+static void usb_stats_install(void) {
+    host_driver_t *driver = host_get_driver();
+    if (driver == NULL || driver == &counted_driver) {
+        return;
+    }
+    usb_driver                   = driver;
+    counted_driver               = *driver;
+    counted_driver.send_keyboard = counted_send_keyboard;
+    counted_driver.send_nkro     = counted_send_nkro;
+    counted_driver.send_mouse    = counted_send_mouse;
+    counted_driver.send_extra    = counted_send_extra;
+    host_set_driver(&counted_driver);
+    window_start = usb_stats_now_us();
+}
+
+void usb_stats_task(void) {
+    if (host_get_driver() != &counted_driver) {
+        usb_stats_install();
+        return;
+    }
+    uint32_t now     = usb_stats_now_us();
+    uint32_t elapsed = now - window_start;
+    if (elapsed < 1000000U) {
+        return;
+    }
+    stats.reports_per_sec = (uint64_t)window_reports * 1000000U / elapsed;
+    if (stats.reports_per_sec > stats.peak_per_sec) {
+        stats.peak_per_sec = stats.reports_per_sec;
+    }
+    window_start   = now;
+    window_reports = 0;
+}
+
+const usb_stats_t *usb_stats(void) {
+    return &stats;
+}
+
+void usb_stats_hid(uint8_t *data, uint8_t length) {
+    if (length < 25) {
+        return;
+    }
+    bool reset = data[0] == 1;
+    olkb_hid_put_u32(&data[0], stats.reports);
+    olkb_hid_put_u32(&data[4], stats.reports_per_sec);
+    olkb_hid_put_u32(&data[8], stats.peak_per_sec);
+    olkb_hid_put_u32(&data[12], stats.busy_waits);
+    olkb_hid_put_u32(&data[16], stats.dropped);
+    olkb_hid_put_u32(&data[20], stats.max_send_us);
+    data[24] = stats.queue_high_water;
+    if (reset) {
+        memset(&stats, 0, sizeof(stats));
+        window_reports = 0;
+        window_start   = usb_stats_now_us();
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * Transport counters for the HID reports the keyboard sends. The host driver
+ * is wrapped once QMK has installed it, and every keyboard, NKRO, mouse and
+ * extra report is timed around the driver call (microseconds with
+ * KEYTIME_ENABLE, otherwise milliseconds).
+ *
+ * The ChibiOS driver queues each report on its IN endpoint and only blocks
+ * when that queue is full, so a slow send is an endpoint-busy wait. A send
+ * that lasts as long as the driver's timeout was dropped. Queue depth is
+ * estimated by assuming the host drains one report per polling interval.
+ */
+
+/* Host polling interval the queue estimate drains at */
+#ifndef USB_STATS_INTERVAL_US
+#    define USB_STATS_INTERVAL_US 1000
+#endif
+
+/* A send that blocks longer than this waited for a busy endpoint */
+#ifndef USB_STATS_BUSY_US
+#    define USB_STATS_BUSY_US 100
+#endif
+
+/* A send that blocks this long hit the driver's 100 ms timeout */
+#ifndef USB_STATS_DROP_US
+#    define USB_STATS_DROP_US 95000
+#endif
+
+typedef struct {
+    uint32_t reports;          /* reports sent since boot or the last reset */
+    uint32_t reports_per_sec;  /* over the last full second */
+    uint32_t peak_per_sec;     /* highest reports_per_sec seen */
+    uint32_t busy_waits;       /* sends that blocked on a full endpoint queue */
+    uint32_t dropped;          /* sends that timed out and were discarded */
+    uint32_t max_send_us;      /* longest single send */
+    uint8_t  queue_high_water; /* deepest estimated endpoint queue */
+} usb_stats_t;
+
+/* Wraps the host driver once it exists and rolls the per-second window */
+void usb_stats_task(void);
+
+const usb_stats_t *usb_stats(void);
+
+/* Raw HID request: [1] resets the counters after replying.
+   Reply: reports, reports/s, peak reports/s, busy waits, dropped,
+   max send us (u32 each), queue high-water mark (u8). */
+void usb_stats_hid(uint8_t *data, uint8_t length);
@@ -3,18 +3,136 @@
 ZSA Oryx to OLKB Planck Rev6 Vial Keymap Converter
 Converts ZSA Oryx keymap exports to QMK-compatible Planck Rev6 keymaps with Vial support.
 """
+import argparse
 import re
 import os
+import shutil
+import subprocess
 import sys
+import tempfile
 
 # Configuration
 INPUT_FILE = "zsa_oryx_source/keymap.c"
+EXPANSIONS_FILE = "zsa_oryx_source/expansions.txt"
 OUTPUT_DIR = "olkb_firmware"
 OUTPUT_KEYMAP = os.path.join(OUTPUT_DIR, "keymap.c")
+OUTPUT_LAYERS_C = os.path.join(OUTPUT_DIR, "keymap_layers.c")
+OUTPUT_LAYERS_H = os.path.join(OUTPUT_DIR, "keymap_layers.h")
 OUTPUT_RULES = os.path.join(OUTPUT_DIR, "rules.mk")
 OUTPUT_CONFIG = os.path.join(OUTPUT_DIR, "config.h")
 OUTPUT_VIAL_JSON = os.path.join(OUTPUT_DIR, "vial.json")
 
+# Firmware modules shipped next to this script and copied into OUTPUT_DIR
+MODULES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "olkb_modules")
+
+# Always built: owns the QMK *_user hooks and dispatches to enabled modules
+CORE_MODULES = ["olkb_hooks.c", "olkb_hooks.h", "olkb_hid.c", "olkb_hid.h"]
+
+# QMK/Vial header stand-ins for the pre-flight compile of the generated keymap
+STUBS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "qmk_stubs")
+
+# Optional modules: (rules.mk flag, default, sources, description)
+FEATURE_MODULES = [
+    ("KEYTIME_ENABLE", True, ["keytime.c", "keytime.h"],
+     "Microsecond matrix edge timestamps (DWT cycle counter) for tap/hold decisions"),
+    ("HAND_RESOLUTION_ENABLE", True, ["hand_resolution.c", "hand_resolution.h"],
+     "Opposite-hand tap/hold resolution for mod-taps and hold dances"),
+    ("BOOT_PROFILE_ENABLE", True, ["boot_profile.c", "boot_profile.h"],
+     "Boot phase timestamps, readable over raw HID"),
+    ("EAGER_MODS_ENABLE", False, ["eager_mods.c", "eager_mods.h"],
+     "Eager modifiers: MT() and hold-to-modifier dances press the modifier immediately"),
+    ("TYPING_SPEED_ENABLE", False, ["typing_speed.c", "typing_speed.h"],
+     "Typing-speed-adaptive tapping term and interrupt handling"),
+    ("TEXT_EXPANSION_ENABLE", False, ["text_expansion.c", "text_expansion.h"],
+     "On-device text expansion (triggers from zsa_oryx_source/expansions.txt)"),
+    ("KINETIC_MOUSE_ENABLE", False, ["kinetic_mouse.c", "kinetic_mouse.h"],
+     "Fixed-point kinetic mouse-key cursor movement at the 1 kHz USB rate"),
+    ("ADAPTIVE_DEBOUNCE_ENABLE", False, ["adaptive_debounce.c", "adaptive_debounce.h"],
+     "Per-key debounce windows that widen only on keys seen chattering"),
+    ("BULK_KEYMAP_ENABLE", True, ["bulk_keymap.c", "bulk_keymap.h"],
+     "Sequenced bulk keymap writes over raw HID (used by scripts/olkb_hid_client.py)"),
+    ("DANCE_ENGINE_ENABLE", False, ["dance_engine.c", "dance_engine.h"],
+     "Per-key tap dance engine: rolled dance keys resolve independently, in press order"),
+    ("DMA_MATRIX_ENABLE", False, ["dma_matrix.c", "dma_matrix.h"],
+     "Timer-paced DMA matrix sampling (replaces the GPIO scanner; uses TIM1 and DMA1 ch2-6)"),
+    ("USB_STATS_ENABLE", True, ["usb_stats.c", "usb_stats.h"],
+     "HID report rate, endpoint queue depth, busy-wait and drop counters, readable over raw HID"),
+    ("SETTLE_CALIBRATION_ENABLE", False, ["settle_calibration.c", "settle_calibration.h"],
+     "Boot-calibrated row settle wait instead of the fixed MATRIX_IO_DELAY (not with DMA_MATRIX_ENABLE)"),
+    ("EDGE_RING_ENABLE", False, ["edge_ring.c", "edge_ring.h"],
+     "Matrix scanned from the system tick into a timestamped edge ring (replaces the GPIO scanner)"),
+]
+
+# Extra rules.mk lines a module needs while it is enabled
+MODULE_RULES = {
+    "ADAPTIVE_DEBOUNCE_ENABLE": ["DEBOUNCE_TYPE = custom"],
+    "DMA_MATRIX_ENABLE": ["CUSTOM_MATRIX = lite"],
+    "EDGE_RING_ENABLE": ["CUSTOM_MATRIX = lite"],
+}
+
+# Module sources that need ChibiOS/STM32 headers; the pre-flight leaves them to qmk compile
+MCU_MODULE_SOURCES = {"dma_matrix.c", "edge_ring.c", "kinetic_mouse.c", "settle_calibration.c"}
+
+# Features often switched off in rules.mk; the pre-flight also checks keymap.c without them
+PREFLIGHT_OPTIONAL_FLAGS = ["AUDIO_ENABLE", "MUSIC_ENABLE"]
+
+# Sources written by the converter itself, built alongside a module
+GENERATED_SOURCES = {
+    "TEXT_EXPANSION_ENABLE": ["text_expansion_data.c"],
+}
+
+# Characters a text expansion trigger may use. The order must match
+# text_expansion_symbol() in olkb_modules/text_expansion.c.
+TEXT_EXPANSION_ALPHABET = "abcdefghijklmnopqrstuvwxyz1234567890;,."
+
+# Mouse-key cursor keycodes (legacy and current names); any of them in a
+# layer turns on KINETIC_MOUSE_ENABLE
+MOUSE_CURSOR_RE = re.compile(r"\b(?:KC_MS_(?:UP|DOWN|LEFT|RIGHT|U|D|L|R)|MS_(?:UP|DOWN|LEFT|RGHT)|QK_MOUSE_CURSOR_\w+)\b")
+
+# Keycode families the pre-flight declares itself when qmk_stubs/ lacks a name,
+# so the stubs need not track every QMK keycode
+PREFLIGHT_KEYCODE_RE = re.compile(r"\b(?:KC|QK|RGB|RM|UG|MS|AU|MU|MI|BL|EE|DB|CW|AS|DT|DM|NK|CM|SQ|HF|JS|SH|UC|PB|TL|MAGIC)_[A-Z0-9_]+\b")
+
+# Headers keymap.c needs for the code patched into the Oryx dances; olkb_hooks.h
+# also checks renamed *_oryx hooks against the signatures the chain calls
+KEYMAP_MODULE_HEADERS = ["olkb_hooks.h", "hand_resolution.h", "eager_mods.h"]
+
+# QMK user hooks implemented by olkb_hooks.c. If the Oryx export defines one,
+# it is renamed to <hook>_oryx and called from the module chain instead.
+OWNED_HOOKS = [
+    "keyboard_pre_init_user",
+    "matrix_init_user",
+    "keyboard_post_init_user",
+    "matrix_scan_user",
+    "housekeeping_task_user",
+    "pre_process_record_user",
+    "process_record_user",
+    "post_process_record_user",
+    "get_hold_on_other_key_press",
+    "get_tapping_term",
+]
+
+# Per-key hooks olkb_hooks.c wraps even with their module off, so a renamed
+# Oryx definition is still called: hook -> (marker define, QMK per-key option)
+ORYX_PER_KEY_HOOKS = {
+    "get_hold_on_other_key_press": ("OLKB_ORYX_HOLD_ON_OTHER_KEY_PRESS", "HOLD_ON_OTHER_KEY_PRESS_PER_KEY"),
+    "get_tapping_term": ("OLKB_ORYX_TAPPING_TERM", "TAPPING_TERM_PER_KEY"),
+}
+
+def write_if_changed(path, content):
+    """
+    Write content only if it differs from what is on disk, so unchanged
+    outputs keep their mtime and make does not rebuild them.
+    Returns True if the file was written.
+    """
+    if os.path.exists(path):
+        with open(path, "r", encoding="utf-8") as f:
+            if f.read() == content:
+                return False
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(content)
+    return True
+
 def split_keycodes(content):
     """
     Splits a string of comma-separated keycodes while respecting nested parentheses.
@@ -110,6 +228,381 @@ def comment_out_function(content, function_name):
     
     return new_content
 
+def rename_user_hook(content, hook_name):
+    """
+    Rename an Oryx definition (and prototype) of a QMK hook owned by olkb_hooks.c.
+    "foo_user" becomes "foo_oryx"; other hooks get an "_oryx" suffix.
+    """
+    base = hook_name[:-len("_user")] if hook_name.endswith("_user") else hook_name
+    pattern = re.compile(r"\b" + re.escape(hook_name) + r"(\s*\()")
+    if not pattern.search(content):
+        return content
+    print(f"Chaining Oryx {hook_name} behind olkb_hooks.c...")
+    return pattern.sub(base + r"_oryx\1", content)
+
+# Keycodes a dance may hold that are a bare modifier (eligible for EAGER_MODS_ENABLE)
+MODIFIER_KEYCODES = {
+    "KC_LEFT_CTRL", "KC_LCTL", "KC_LEFT_SHIFT", "KC_LSFT", "KC_LEFT_ALT", "KC_LALT", "KC_LEFT_GUI", "KC_LGUI",
+    "KC_RIGHT_CTRL", "KC_RCTL", "KC_RIGHT_SHIFT", "KC_RSFT", "KC_RIGHT_ALT", "KC_RALT", "KC_RIGHT_GUI", "KC_RGUI",
+}
+
+def dance_finished_body(content, index):
+    """Return the body of dance_<index>_finished, or "" if it is not defined."""
+    match = re.search(r"void\s+dance_" + str(index) + r"_finished\s*\([^)]*\)\s*\{", content)
+    if not match:
+        return ""
+    end = content.find("\nvoid ", match.end())
+    return content[match.end():end if end != -1 else len(content)]
+
+def dance_hold_modifier(content, index):
+    """The bare modifier keycode a dance registers on SINGLE_HOLD, or None."""
+    match = re.search(r"case SINGLE_HOLD:\s*register_code16\((KC_\w+)\);", dance_finished_body(content, index))
+    if match and match.group(1) in MODIFIER_KEYCODES:
+        return match.group(1)
+    return None
+
+def dance_holds_modifier_or_layer(content, index):
+    """True if a dance's SINGLE_HOLD registers a modifier or turns on a layer."""
+    match = re.search(r"case SINGLE_HOLD:(.*?)break;", dance_finished_body(content, index), re.DOTALL)
+    if not match:
+        return False
+    return dance_hold_modifier(content, index) is not None or re.search(r"\blayer_(?:on|move)\(", match.group(1)) is not None
+
+def eager_dance_entries(content):
+    """
+    eager_dance_mods[] initialiser lines: the MOD_BIT each dance holds on
+    SINGLE_HOLD, 0 for the others. Every dance gets an entry, since eager_mods
+    also tracks which dances are still unresolved.
+    """
+    indices = sorted({int(i) for i in re.findall(r"dance_state\[(\d+)\]\.step = dance_step\(state\);", content)})
+    entries = []
+    for index in indices:
+        modifier = dance_hold_modifier(content, index)
+        entries.append(f"    [DANCE_{index}] = {f'MOD_BIT({modifier})' if modifier else '0'},")
+    return entries
+
+def insert_eager_dance_table(content, entries, actions_name="tap_dance_actions"):
+    """
+    Insert eager_dance_mods[] (0 for dances without a modifier hold) ahead
+    of tap_dance_actions for the eager_mods module.
+    """
+    table = "\n".join([
+        "#ifdef EAGER_MODS_ENABLE",
+        "const uint8_t PROGMEM eager_dance_mods[] = {",
+        *(entries or ["    0,"]),
+        "};",
+        "const uint8_t eager_dance_mods_count = sizeof(eager_dance_mods);",
+        "#endif",
+        "",
+        "",
+    ])
+    match = re.search(r"^tap_dance_action_t\s+" + re.escape(actions_name) + r"\[\]", content, re.MULTILINE)
+    if not match:
+        return content
+    return content[:match.start()] + table + content[match.start():]
+
+def patch_dance_finished(content):
+    """
+    Insert module resolution steps after each 'dance_state[N].step = dance_step(state);'
+    so modules can re-resolve a dance knowing which dance it is.
+    """
+    step_pattern = re.compile(r"^([ \t]*)dance_state\[(\d+)\]\.step = dance_step\(state\);[ \t]*$", re.MULTILINE)
+
+    def insert(match):
+        indent, index = match.group(1), match.group(2)
+        lines = [match.group(0)]
+        # Only a modifier or layer hold is meant to act on the next key; a
+        # dance holding to a plain key (Space/Enter) must not turn rolls into it
+        if dance_holds_modifier_or_layer(content, index):
+            lines.append("#ifdef HAND_RESOLUTION_ENABLE")
+            lines.append(f"{indent}if (dance_state[{index}].step == SINGLE_TAP && hand_resolution_dance_hold(DANCE_{index}, state)) dance_state[{index}].step = SINGLE_HOLD;")
+            lines.append("#endif")
+        # Retract an eagerly pressed modifier unless the dance became its hold,
+        # and let eager_mods know the dance is no longer pending
+        lines.append("#ifdef EAGER_MODS_ENABLE")
+        lines.append(f"{indent}eager_mods_dance_resolve(DANCE_{index}, dance_state[{index}].step == SINGLE_HOLD);")
+        lines.append("#endif")
+        return "\n".join(lines)
+
+    return step_pattern.sub(insert, content)
+
+def function_span(content, function_name):
+    """(start, end) of the definition of void function_name(...) { ... }, or None."""
+    match = re.search(r"^void\s+" + re.escape(function_name) + r"\s*\([^)]*\)\s*\{", content, re.MULTILINE)
+    if not match:
+        return None
+    depth = 1
+    i = match.end()
+    while i < len(content) and depth > 0:
+        if content[i] == '{':
+            depth += 1
+        elif content[i] == '}':
+            depth -= 1
+        i += 1
+    return match.start(), i
+
+def remove_function(content, function_name):
+    """Drop the definition and prototype of function_name."""
+    span = function_span(content, function_name)
+    if span:
+        content = content[:span[0]] + content[span[1]:].lstrip("\n")
+    return re.sub(r"^void\s+" + re.escape(function_name) + r"\s*\([^)]*\)\s*;[ \t]*\n", "", content, flags=re.MULTILINE)
+
+def canonical_dance_body(content, function_name, index):
+    """Whitespace-normalised body with the dance index abstracted, or None."""
+    span = function_span(content, function_name)
+    if not span:
+        return None
+    body = content[content.index("{", span[0]):span[1]]
+    body = re.sub(r"dance_state\[" + str(index) + r"\]", "dance_state[#]", body)
+    body = re.sub(r"\bDANCE_" + str(index) + r"\b", "DANCE_#", body)
+    return re.sub(r"\s+", " ", body).strip()
+
+def share_dance_body(content, function_names, indices):
+    """
+    Turn the first of identical dance callbacks into dance_<i>_<kind>_shared,
+    taking the dance_state slot and the DANCE_ value as parameters, and make
+    every dance_<n>_<kind> (the first one included) a one-line call to it.
+    Each dance keeps its own callback and dance_state entry.
+    """
+    first = indices[0]
+    span = function_span(content, function_names[first])
+    body = content[content.index("{", span[0]):span[1]]
+    body = re.sub(r"dance_state\[" + str(first) + r"\]", "dance_state[slot]", body)
+    body = re.sub(r"\bDANCE_" + str(first) + r"\b", "dance", body)
+    shared_name = function_names[first] + "_shared"
+    shared = f"static void {shared_name}(tap_dance_state_t *state, uint8_t slot, uint8_t dance) {body}\n\n"
+    for index in indices:
+        span = function_span(content, function_names[index])
+        open_brace = content.index("{", span[0])
+        call = f"{{\n    {shared_name}(state, {index}, DANCE_{index});\n}}"
+        content = content[:open_brace] + call + content[span[1]:]
+    start = function_span(content, function_names[first])[0]
+    return content[:start] + shared + content[start:]
+
+# Rough Thumb-2 cost of a dance callback: prologue/epilogue plus one call per statement
+FUNCTION_BASE_BYTES = 8
+FUNCTION_STATEMENT_BYTES = 6
+
+def estimate_function_bytes(canonical_body):
+    return FUNCTION_BASE_BYTES + FUNCTION_STATEMENT_BYTES * canonical_body.count(";")
+
+def deduplicate_dances(content):
+    """
+    Share identical dance callbacks. on_dance_N bodies that do not touch the
+    dance's state are merged outright. Identical finished or reset bodies go
+    into one function taking the dance as a parameter (see share_dance_body),
+    so every dance keeps its own dance_state entry and module slots even when
+    two are pressed together. Runs after patch_dance_finished, whose lines are
+    part of the bodies compared.
+    Returns (content, callbacks shared, estimated bytes saved).
+    """
+    action_re = re.compile(r"^([ \t]*)\[DANCE_(\d+)\]\s*=\s*ACTION_TAP_DANCE_FN_ADVANCED\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*\),", re.MULTILINE)
+    actions = {int(m.group(2)): [m.group(3), m.group(4), m.group(5)] for m in action_re.finditer(content)}
+    removed = []
+
+    def drop(name, body):
+        nonlocal content
+        content = remove_function(content, name)
+        removed.append((name, estimate_function_bytes(body)))
+
+    # 1. on_each_tap callbacks
+    seen_on = {}
+    for index, fns in sorted(actions.items()):
+        body = canonical_dance_body(content, fns[0], index) if fns[0] != "NULL" else None
+        if body is None or "#" in body:
+            continue
+        if body in seen_on:
+            drop(fns[0], body)
+            fns[0] = seen_on[body]
+        else:
+            seen_on[body] = fns[0]
+
+    def rewrite(match):
+        fns = actions[int(match.group(2))]
+        return f"{match.group(1)}[DANCE_{match.group(2)}] = ACTION_TAP_DANCE_FN_ADVANCED({fns[0]}, {fns[1]}, {fns[2]}),"
+    content = action_re.sub(rewrite, content)
+
+    # 2. finished and reset bodies, parameterised on the dance
+    for slot, kind in ((1, "finished"), (2, "reset")):
+        groups = {}
+        for index, fns in sorted(actions.items()):
+            body = canonical_dance_body(content, fns[slot], index)
+            if body is not None:
+                groups.setdefault(body, []).append(index)
+        for body, indices in groups.items():
+            if len(indices) < 2:
+                continue
+            print(f"Dances {', '.join(f'DANCE_{i}' for i in indices)} share one {kind} body")
+            content = share_dance_body(content, {i: actions[i][slot] for i in indices}, indices)
+            # Every copy after the first is gone; each dance keeps a one-call wrapper
+            for index in indices[1:]:
+                removed.append((actions[index][slot], estimate_function_bytes(body) - estimate_function_bytes("call;")))
+
+    return content, len(removed), sum(size for _, size in removed)
+
+def report_layer_duplicates(layers):
+    """
+    Report layers that are copies of an earlier one or fully transparent.
+    QMK indexes keymaps[] by layer number (and Vial seeds its EEPROM copy from
+    it), so such layers keep their slot; this only says how much flash dropping
+    them from the Oryx layout would save. Returns the bytes that could be saved.
+    """
+    transparent = {"KC_TRANSPARENT", "KC_TRNS", "_______"}
+    layer_bytes = 8 * 6 * 2
+    seen = {}
+    wasted = 0
+    for name, keys in layers:
+        matrix = tuple(tuple(row) for row in transpose_to_olkb_matrix(keys))
+        if all(key in transparent for row in matrix for key in row):
+            print(f"Note: layer {name} is fully transparent ({layer_bytes} bytes of keymap data)")
+            wasted += layer_bytes
+        elif matrix in seen:
+            print(f"Note: layer {name} is identical to {seen[matrix]} ({layer_bytes} bytes of keymap data)")
+            wasted += layer_bytes
+        else:
+            seen[matrix] = name
+    return wasted
+
+def copy_modules(output_dir):
+    """Copy the olkb_hooks core and every feature module into the output folder."""
+    names = list(CORE_MODULES)
+    for _, _, sources, _ in FEATURE_MODULES:
+        names.extend(sources)
+    for name in names:
+        with open(os.path.join(MODULES_DIR, name), "r", encoding="utf-8") as f:
+            write_if_changed(os.path.join(output_dir, name), f.read())
+    print(f" ✓ Copied {len(names)} module files")
+
+def c_string(text):
+    """Quote text as a C string literal."""
+    escaped = text.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n").replace("\t", "\\t")
+    return f'"{escaped}"'
+
+def parse_expansions(path):
+    """
+    Read '<trigger> = <expansion>' lines. '#' starts a comment line and
+    '\\n' in an expansion presses Enter. Returns a list of (trigger, expansion).
+    """
+    if not os.path.exists(path):
+        return []
+    expansions = []
+    with open(path, "r", encoding="utf-8") as f:
+        for line_no, line in enumerate(f, 1):
+            line = line.rstrip("\n")
+            if not line.strip() or line.lstrip().startswith("#"):
+                continue
+            if " = " not in line:
+                print(f"Warning: {path}:{line_no}: expected '<trigger> = <expansion>', skipped.")
+                continue
+            trigger, expansion = line.split(" = ", 1)
+            trigger = trigger.strip().lower()
+            bad = [c for c in trigger if c not in TEXT_EXPANSION_ALPHABET]
+            if not trigger or bad:
+                print(f"Warning: {path}:{line_no}: trigger '{trigger}' may only use '{TEXT_EXPANSION_ALPHABET}', skipped.")
+                continue
+            expansion = expansion.replace("\\n", "\n")
+            if any(ord(c) > 126 for c in expansion):
+                print(f"Warning: {path}:{line_no}: expansion must be ASCII, skipped.")
+                continue
+            expansions.append((trigger, expansion))
+    return expansions
+
+def build_expansion_automaton(expansions):
+    """
+    Build a trie of the triggers and fold its failure links into a full
+    transition table (Aho-Corasick), so the firmware advances one state per
+    keystroke with a single table lookup whatever the dictionary size.
+    Returns (next_table, match) where match[state] is expansion index + 1 or 0.
+    """
+    symbols = len(TEXT_EXPANSION_ALPHABET)
+    children = [{}]
+    match = [0]
+    for index, (trigger, _) in enumerate(expansions):
+        state = 0
+        for char in trigger:
+            symbol = TEXT_EXPANSION_ALPHABET.index(char)
+            if symbol not in children[state]:
+                children.append({})
+                match.append(0)
+                children[state][symbol] = len(children) - 1
+            state = children[state][symbol]
+        if match[state]:
+            print(f"Warning: duplicate trigger '{trigger}', keeping the first expansion.")
+        else:
+            match[state] = index + 1
+
+    next_table = [[0] * symbols for _ in children]
+    fail = [0] * len(children)
+    queue = []
+    for symbol in range(symbols):
+        child = children[0].get(symbol)
+        if child is not None:
+            next_table[0][symbol] = child
+            queue.append(child)
+    while queue:
+        state = queue.pop(0)
+        # A shorter trigger that ends here still fires
+        if not match[state]:
+            match[state] = match[fail[state]]
+        for symbol in range(symbols):
+            child = children[state].get(symbol)
+            if child is None:
+                next_table[state][symbol] = next_table[fail[state]][symbol]
+            else:
+                fail[child] = next_table[fail[state]][symbol]
+                next_table[state][symbol] = child
+                queue.append(child)
+    return next_table, match
+
+def generate_text_expansion_data(output_dir, expansions):
+    """Emit text_expansion_data.c/.h with the PROGMEM automaton and expansion strings."""
+    next_table, match = build_expansion_automaton(expansions)
+    state_type = "uint8_t" if len(next_table) <= 0x100 else "uint16_t"
+    index_type = "uint8_t" if len(expansions) < 0xFF else "uint16_t"
+
+    header = f"""// Generated by oryx_to_olkb.py from {EXPANSIONS_FILE}
+#pragma once
+
+#include "quantum.h"
+
+#define TEXT_EXPANSION_SYMBOLS {len(TEXT_EXPANSION_ALPHABET)}
+#define TEXT_EXPANSION_STATES {len(next_table)}
+#define TEXT_EXPANSION_COUNT {len(expansions)}
+
+typedef {state_type} text_expansion_state_t;
+typedef {index_type} text_expansion_index_t;
+
+extern const text_expansion_state_t text_expansion_next[TEXT_EXPANSION_STATES][TEXT_EXPANSION_SYMBOLS] PROGMEM;
+extern const text_expansion_index_t text_expansion_match[TEXT_EXPANSION_STATES] PROGMEM;
+extern const uint8_t text_expansion_trigger_length[] PROGMEM;
+extern const char *const text_expansion_text[] PROGMEM;
+"""
+    rows = []
+    for state, row in enumerate(next_table):
+        rows.append("    { " + ", ".join(str(v) for v in row) + " }," + f" // {state}")
+    strings = []
+    for index, (trigger, expansion) in enumerate(expansions):
+        strings.append(f"static const char text_{index}[] PROGMEM = {c_string(expansion)}; // {trigger}")
+    source = f"""// Generated by oryx_to_olkb.py from {EXPANSIONS_FILE}
+#include "text_expansion_data.h"
+
+const text_expansion_state_t text_expansion_next[TEXT_EXPANSION_STATES][TEXT_EXPANSION_SYMBOLS] PROGMEM = {{
+{chr(10).join(rows)}
+}};
+
+const text_expansion_index_t text_expansion_match[TEXT_EXPANSION_STATES] PROGMEM = {{ {", ".join(str(m) for m in match)} }};
+
+const uint8_t text_expansion_trigger_length[] PROGMEM = {{ {", ".join(str(len(t)) for t, _ in expansions) or "0"} }};
+
+{chr(10).join(strings)}
+
+const char *const text_expansion_text[] PROGMEM = {{ {", ".join(f"text_{i}" for i in range(len(expansions))) or "NULL"} }};
+"""
+    write_if_changed(os.path.join(output_dir, "text_expansion_data.h"), header)
+    write_if_changed(os.path.join(output_dir, "text_expansion_data.c"), source)
+    print(f" ✓ Generated text_expansion_data.c ({len(expansions)} expansions, {len(next_table)} states)")
+
 def parse_zsa_layers(content: str):
     """Parse the ZSA keymaps array and extract per-layer 4x12 key lists."""
     
@@ -178,9 +671,13 @@ def transpose_to_olkb_matrix(keys):
 
 
 def generate_keymaps_block(layers):
-    """Generate the full const keymaps block for the OLKB matrix."""
+    """
+    Generate the full const keymaps block for the OLKB matrix.
+    The layer count is explicit so keymap_layers.h can declare the array with
+    a complete type (QMK introspection takes sizeof(keymaps) in keymap.c).
+    """
     output = []
-    output.append("const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {")
+    output.append("const uint16_t PROGMEM keymaps[KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS] = {")
 
     for layer_name, keys in layers:
         matrix = transpose_to_olkb_matrix(keys)
@@ -197,11 +694,13 @@ def generate_keymaps_block(layers):
     output.append("};")
     return "\n".join(output)
 
-def generate_rules_mk(output_path):
+def generate_rules_mk(output_path, feature_overrides=None):
     """
     Generate rules.mk with complete Vial and feature support.
     UPDATED: Disables LTO, COMBO, KEY_OVERRIDE to prevent compilation errors.
+    feature_overrides maps a module flag to the default the input calls for.
     """
+    feature_overrides = feature_overrides or {}
     rules_content = """# Generated by oryx_to_olkb.py
 # Planck Rev6 Vial Keymap Build Rules
 
@@ -227,15 +726,37 @@ LTO_ENABLE = no
 # Introspection fix (Disabled to prevent conflicts with Vial's internal definitions)
 COMBO_ENABLE = no
 KEY_OVERRIDE_ENABLE = no
+
+# Keymap data lives in its own TU so a layer-only change rebuilds just that file
+SRC += keymap_layers.c
+
+# Converter hook dispatcher (owns the *_user hooks used by the modules below)
+# and the raw HID channel the modules report through
+SRC += olkb_hooks.c olkb_hid.c
 """
-    with open(output_path, 'w') as f:
-        f.write(rules_content)
+    for flag, default, sources, description in FEATURE_MODULES:
+        default = feature_overrides.get(flag, default)
+        c_sources = " ".join([src for src in sources if src.endswith(".c")] + GENERATED_SOURCES.get(flag, []))
+        extra_rules = "".join(f"    {line}\n" for line in MODULE_RULES.get(flag, []))
+        rules_content += f"""
+# {description}
+{flag} = {"yes" if default else "no"}
+ifeq ($(strip $({flag})), yes)
+{extra_rules}    SRC += {c_sources}
+    OPT_DEFS += -D{flag}
+endif
+"""
+    write_if_changed(output_path, rules_content)
 
     print(f" ✓ Generated rules.mk")
 
-def generate_config_h(output_path):
+def generate_config_h(output_path, profile_count=1, layer_count=None, oryx_hooks=(), tapping_term=None):
     """
     Generate config.h with Vial UID and unlock combo.
+    A multi-profile build also sizes Vial's layer storage for every profile.
+    oryx_hooks are the ORYX_PER_KEY_HOOKS the export defines. tapping_term
+    (read_tapping_term) is the single export's own term; merged builds keep
+    each profile's in olkb_profiles[] instead.
     REMOVED: VIAL_TAP_DANCE_ENABLE definition (caused redefinition errors with quantum/vial.h)
     """
     config_content = """#pragma once
@@ -251,9 +772,52 @@ def generate_config_h(output_path):
 /* Planck matrix: Left half = rows 0-3, Right half = rows 4-7, Cols = 0-5 */
 #define VIAL_UNLOCK_COMBO_ROWS { 0, 4 }
 #define VIAL_UNLOCK_COMBO_COLS { 0, 5 }
+
+/* 3. Opposite-hand tap/hold: same-hand interrupts tap, opposite-hand interrupts hold */
+#ifdef HAND_RESOLUTION_ENABLE
+#define CHORDAL_HOLD
+#define HOLD_ON_OTHER_KEY_PRESS_PER_KEY
+#endif
+
+/* 4. Typing-speed-adaptive tap/hold: per-key term and Flow Tap are driven by typing_speed.c */
+#ifdef TYPING_SPEED_ENABLE
+#define TAPPING_TERM_PER_KEY
+#define FLOW_TAP_TERM 150
+#endif
+
+/* 5. Play the startup song after the first matrix scan instead of during init */
+#ifdef AUDIO_ENABLE
+#undef STARTUP_SONG
+#define STARTUP_SONG SONG(NO_SOUND)
+#define OLKB_LAZY_STARTUP_SONG SONG(PLANCK_SOUND)
+#endif
+"""
+    # QMK per-key options the sections below need, each defined once
+    per_key_options = []
+    if profile_count > 1:
+        config_content += f"""
+/* 6. Profiles: {profile_count} Oryx exports packed side by side, each with its own tapping term */
+#define OLKB_PROFILE_COUNT {profile_count}
+#define DYNAMIC_KEYMAP_LAYER_COUNT {layer_count}
+"""
+        if layer_count > 16:
+            config_content += "#define LAYER_STATE_32BIT\n"
+        per_key_options.append("TAPPING_TERM_PER_KEY")
+    elif tapping_term is not None:
+        config_content += f"""
+/* 6. Tapping term from the Oryx config.h */
+#undef TAPPING_TERM
+#define TAPPING_TERM {tapping_term}
 """
-    with open(output_path, 'w') as f:
-        f.write(config_content)
+    if oryx_hooks:
+        config_content += "\n/* 7. Per-key hooks from the Oryx export, wrapped by olkb_hooks.c */\n"
+        for hook in oryx_hooks:
+            marker, option = ORYX_PER_KEY_HOOKS[hook]
+            config_content += f"#define {marker}\n"
+            per_key_options.append(option)
+    for option in dict.fromkeys(per_key_options):
+        config_content += f"#define {option}\n"
+    write_if_changed(output_path, config_content)
 
     print(f" ✓ Generated config.h")
 
@@ -279,27 +843,26 @@ def generate_vial_json(output_path):
     ]
   }
 }"""
-    with open(output_path, 'w') as f:
-        f.write(vial_json_content)
+    write_if_changed(output_path, vial_json_content)
         
     print(f" ✓ Generated vial.json")
 
-def main():
-    if not os.path.exists(INPUT_FILE):
-        print(f"Error: Input file '{INPUT_FILE}' not found.")
-        print("Place your ZSA 'keymap.c' in the 'zsa_oryx_source' folder.")
-        sys.exit(1)
-
-    print(f"Reading from {INPUT_FILE}...")
-    with open(INPUT_FILE, "r", encoding="utf-8") as f:
-        content = f.read()
-
+def convert_keymap_source(content, eager_table=True):
+    """
+    Convert one Oryx keymap.c. Returns (converted source, keymaps block, layer count);
+    the keymaps block appears verbatim in the converted source. Without
+    eager_table the caller builds eager_dance_mods[] (multi-profile builds
+    merge one table for all profiles).
+    """
     layers = parse_zsa_layers(content)
     if not layers:
         print("No layers found or parse error.")
         sys.exit(1)
 
     print(f"Found {len(layers)} layers. Converting keymaps...")
+    layer_bytes = report_layer_duplicates(layers)
+    if layer_bytes:
+        print(f"               {layer_bytes} bytes of flash held by duplicate or transparent layers")
 
     new_keymaps_block = generate_keymaps_block(layers)
 
@@ -311,7 +874,7 @@ def main():
         print("Error: Could not replace keymaps array in input file.")
         sys.exit(1)
 
-    new_content = re.sub(full_pattern, new_keymaps_block, content, count=1)
+    new_content = re.sub(full_pattern, lambda _: new_keymaps_block, content, count=1)
 
     # FIX: Add QMK quantum header to resolve missing types/macros (SAFE_RANGE, tap_dance_state_t)
     if '#include "quantum.h"' not in new_content:
@@ -328,7 +891,7 @@ def main():
     
     # FIX: Update layer_state_set_user signature for modern QMK
     new_content = re.sub(
-        r'(?:uint8_t|uint32_t|layer_state_t)\s+layer_state_set_user\s*\(\s*(?:uint8_t|uint32_t|layer_state_t)\\s+state\s*\)',
+        r'(?:uint8_t|uint32_t|layer_state_t)\s+layer_state_set_user\s*\(\s*(?:uint8_t|uint32_t|layer_state_t)\s+state\s*\)',
         r'layer_state_t layer_state_set_user(layer_state_t state)',
         new_content
     )
@@ -339,38 +902,543 @@ def main():
         new_content = comment_out_function(new_content, "matrix_scan_user")
         new_content = re.sub(r'(void\s+matrix_scan_user\s*\([^)]*\)\s*;)', r'// \1', new_content)
 
+    # Chain hooks the Oryx export defines behind olkb_hooks.c
+    for hook_name in OWNED_HOOKS:
+        new_content = rename_user_hook(new_content, hook_name)
+
+    # Let modules re-resolve each dance after dance_step()
+    if eager_table:
+        new_content = insert_eager_dance_table(new_content, eager_dance_entries(new_content))
+    new_content = patch_dance_finished(new_content)
+    new_content, functions_saved, bytes_saved = deduplicate_dances(new_content)
+    print(f"Deduplication: {functions_saved} dance callbacks shared (~{bytes_saved} bytes of flash)")
+    module_includes = "".join(f'#include "{header}"\n' for header in KEYMAP_MODULE_HEADERS)
+    new_content = new_content.replace(
+        '#include "quantum.h" // Added by oryx_to_olkb\n',
+        '#include "quantum.h" // Added by oryx_to_olkb\n' + module_includes, 1)
+
     # FIX: DO NOT wrap tap_dance_actions in #ifndef VIAL_ENABLE.
     # QMK introspection requires it to be visible.
     # We rely on VIAL_TAP_DANCE_ENABLE = no in rules.mk/config.h to prevent linker conflicts.
     # (No code added here to wrap it)
 
+    return new_content, new_keymaps_block, len(layers)
+
+# Preamble pieces keymap_layers.h can take: enums, object/function macros and
+# the `#ifndef X / #define X / #endif` default Oryx gives ZSA_SAFE_RANGE
+PREAMBLE_UNIT_RE = re.compile(
+    r"^(?:typedef\s+)?enum\s*(?P<enum>\w*)\s*\{(?P<members>[^}]*)\}\s*\w*\s*;"
+    r"|^#ifndef\s+(?P<guarded>\w+)\n#define\s+(?P=guarded)\b(?P<guarded_body>[^\n]*)\n#endif[^\n]*"
+    r"|^#define\s+(?P<macro>\w+)(?P<macro_body>[^\n]*)", re.MULTILINE)
+
+def split_preamble(preamble, keymaps_block):
+    """
+    Split a keymap.c preamble into what the keymaps array needs (the enums and
+    macros it names, and the ones those name in turn; custom_keycodes always,
+    since Vial and the other modules key on it) and everything else
+    (module includes, Oryx helpers), which stays in keymap.c.
+    Returns (header part, keymap.c part).
+    """
+    units = []
+    depth = 0
+    last = 0
+    for match in PREAMBLE_UNIT_RE.finditer(preamble):
+        # Only units at file scope, outside any #if block
+        for line in re.findall(r"^\s*#\s*(if|endif)", preamble[last:match.start()], re.MULTILINE):
+            depth += 1 if line == "if" else -1
+        last = match.start()
+        if depth:
+            continue
+        if match.group("members") is not None:
+            names = set(re.findall(r"^\s*(\w+)", match.group("members"), re.MULTILINE))
+            if match.group("enum") == "custom_keycodes":
+                names.add("custom_keycodes")
+            body = match.group("members")
+        elif match.group("guarded"):
+            names, body = {match.group("guarded")}, match.group("guarded_body")
+        else:
+            names, body = {match.group("macro")}, match.group("macro_body")
+        units.append((match.span(), names, set(re.findall(r"\b[A-Za-z_]\w*\b", body))))
+
+    needed = set(re.findall(r"\b[A-Za-z_]\w*\b", keymaps_block)) | {"custom_keycodes"}
+    taken = set()
+    grew = True
+    while grew:
+        grew = False
+        for index, (_, names, uses) in enumerate(units):
+            if index not in taken and names & needed:
+                taken.add(index)
+                needed |= uses
+                grew = True
+
+    header_parts, rest = [], preamble
+    for index in sorted(taken, reverse=True):
+        (start, end), _, _ = units[index]
+        header_parts.insert(0, preamble[start:end])
+        rest = rest[:start] + rest[end:]
+    rest = re.sub(r"\n{3,}", "\n\n", rest).strip()
+    return "\n\n".join(header_parts), rest
+
+def split_keymap_layers(new_content, keymaps_block, layer_count):
+    """
+    Move the keymap data into its own translation unit.
+    keymap_layers.h takes only what the keymaps array names (layer, dance and
+    keycode enums, keycode macros) plus a complete extern declaration; the
+    rest of the preamble (module includes, Oryx helpers) stays in keymap.c.
+    keymap_layers.c holds only the array. A layer-only edit then leaves the
+    header and keymap.c untouched, so only the small data TU is rebuilt.
+    Returns (header, layers source, keymap source).
+    """
+    start = new_content.index(keymaps_block)
+    preamble, preamble_rest = split_preamble(new_content[:start].rstrip(), keymaps_block)
+    rest = new_content[start + len(keymaps_block):].lstrip("\n")
+
+    header = f"""// Generated by oryx_to_olkb.py: declarations shared by keymap.c and keymap_layers.c
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+{preamble}
+
+#define KEYMAP_LAYER_COUNT {layer_count}
+
+extern const uint16_t PROGMEM keymaps[KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+"""
+    layers_source = f"""// Generated by oryx_to_olkb.py: keymap data (Planck Rev6 folded 8x6 matrix)
+#include "keymap_layers.h"
+
+{keymaps_block}
+"""
+    keymap_source = f"""// Converted by oryx_to_olkb.py
+// Retains Vial/OLKB Matrix Compatibility
+#include "keymap_layers.h"
+{preamble_rest}
+
+{rest}"""
+    return header, layers_source, keymap_source
+
+# Hooks a profile may define, dispatched through olkb_profiles[] in a
+# multi-profile build: name -> (return type, parameters, arguments, default)
+PROFILE_HOOKS = {
+    "keyboard_pre_init_oryx": ("void", "void", "", None),
+    "matrix_init_oryx": ("void", "void", "", None),
+    "keyboard_post_init_oryx": ("void", "void", "", None),
+    "housekeeping_task_oryx": ("void", "void", "", None),
+    "pre_process_record_oryx": ("bool", "uint16_t keycode, keyrecord_t *record", "keycode, record", "true"),
+    "process_record_oryx": ("bool", "uint16_t keycode, keyrecord_t *record", "keycode, record", "true"),
+    "post_process_record_oryx": ("void", "uint16_t keycode, keyrecord_t *record", "keycode, record", None),
+    "get_hold_on_other_key_press_oryx": ("bool", "uint16_t keycode, keyrecord_t *record", "keycode, record", "false"),
+    "get_tapping_term_oryx": ("uint16_t", "uint16_t keycode, keyrecord_t *record", "keycode, record", "profile->tapping_term"),
+    "layer_state_set_user": ("layer_state_t", "layer_state_t state", "state", "state"),
+    "music_mask_user": ("bool", "uint16_t keycode", "keycode", "true"),
+}
+
+# Layer keycodes that take a literal layer number (Oryx writes TT(1), LT(5, KC_D))
+LAYER_ARG_RE = re.compile(r"\b(MO|TG|TO|TT|DF|PDF|OSL|LT|LM)\(\s*(\d+)\s*([,)])")
+
+def read_tapping_term(keymap_path):
+    """TAPPING_TERM from the config.h next to an Oryx keymap.c, or None."""
+    config_path = os.path.join(os.path.dirname(keymap_path), "config.h")
+    if not os.path.exists(config_path):
+        return None
+    with open(config_path, "r", encoding="utf-8") as f:
+        match = re.search(r"^#define\s+TAPPING_TERM\s+(\d+)", f.read(), re.MULTILINE)
+    return int(match.group(1)) if match else None
+
+def profile_identifiers(content):
+    """Names a converted export defines at file scope: macros, enums, types, functions, variables."""
+    names = set(re.findall(r"^#define\s+(\w+)", content, re.MULTILINE))
+    for tag, body in re.findall(r"\benum\s+(\w*)\s*\{([^}]*)\}", content):
+        if tag:
+            names.add(tag)
+        names.update(re.findall(r"^\s*(\w+)\s*(?:=[^,]*)?,?\s*(?://.*)?$", body, re.MULTILINE))
+    names.update(re.findall(r"^\}\s*(\w+)\s*;", content, re.MULTILINE))
+    names.update(re.findall(
+        r"^(?!#|//|typedef|enum|return)(?:[A-Za-z_]\w*[ \t\*]+)+\**(\w+)\s*(?:\(|\[|=|;)", content, re.MULTILINE))
+    names.discard("keymaps")
+    return names
+
+def offset_enum_start(content, member, offset):
+    """Give the enum whose first member is `member` the start value `offset`."""
+    return re.sub(r"(\benum\s+\w*\s*\{\s*)" + re.escape(member) + r"\b(?:\s*=\s*[^,}]+)?",
+                  lambda m: f"{m.group(1)}{member} = {offset}", content, count=1)
+
+def enclosing_condition(content, position):
+    """The #if conditions in force at `position`, joined with &&, or None at top level."""
+    def negate(term):
+        return term[1:] if term.startswith("!") else "!" + term
+    stack = []  # per open #if: conditions of the branches already passed, and the current one
+    for match in re.finditer(r"^[ \t]*#[ \t]*(ifdef|ifndef|if|elif|else|endif)\b[ \t]*(.*?)[ \t]*(?://.*)?$",
+                             content[:position], re.MULTILINE):
+        directive, expression = match.groups()
+        if directive in ("ifdef", "ifndef", "if"):
+            term = {"ifdef": f"defined({expression})", "ifndef": f"!defined({expression})"}.get(directive, f"({expression})")
+            stack.append(([], term))
+        elif not stack:
+            continue
+        elif directive == "endif":
+            stack.pop()
+        else:
+            passed, current = stack.pop()
+            stack.append((passed + [current], f"({expression})" if directive == "elif" else None))
+    terms = [term for passed, current in stack for term in [negate(t) for t in passed] + ([current] if current else [])]
+    return " && ".join(terms) if terms else None
+
+def prepare_profile(path, index, layer_offset, dance_offset):
+    """
+    Convert one export as profile `index`: every file-scope name gets a _p<index>
+    suffix, and its layer and dance enums (plus literal layer numbers in
+    keycodes) start at the given offsets so they index the merged keymaps[]
+    and tap_dance_actions[].
+    """
+    print(f"Reading profile {index} from {path}...")
+    with open(path, "r", encoding="utf-8") as f:
+        source = f.read()
+    content, keymaps_block, layer_count = convert_keymap_source(source, eager_table=False)
+
+    layer_names = re.findall(r"^    \[(\w+)\] = \{", keymaps_block, re.MULTILINE)
+    dance_count = len(set(re.findall(r"\bDANCE_(\d+)\s*,", content)))
+    # From the export itself: shared dance bodies no longer name their dance
+    eager_entries = eager_dance_entries(source)
+
+    def shift_layers(text):
+        def shift(match):
+            layer = int(match.group(2)) + layer_offset
+            if match.group(1) in ("LT", "LM") and layer > 15:
+                print(f"Warning: profile {index}: {match.group(1)}() only reaches layers 0-15, got layer {layer}")
+            return f"{match.group(1)}({layer}{match.group(3)}"
+        return LAYER_ARG_RE.sub(shift, text)
+
+    names = profile_identifiers(content)
+    # Struct members (record->tap) share names with Oryx's `tap` type; leave them alone
+    rename_re = re.compile(r"(?<!\.)(?<!->)\b(" + "|".join(sorted(map(re.escape, names), key=len, reverse=True)) + r")\b")
+    def rename(text):
+        return rename_re.sub(lambda m: f"{m.group(1)}_p{index}", shift_layers(text))
+
+    numbered = re.sub(r"^    \[(\d+)\] = \{", lambda m: f"    [{int(m.group(1)) + layer_offset}] = {{", keymaps_block, flags=re.MULTILINE)
+    content = content.replace(keymaps_block, numbered)
+    content, keymaps_block = rename(content), rename(numbered)
+    if layer_names:
+        content = offset_enum_start(content, f"{layer_names[0]}_p{index}", layer_offset)
+    if dance_count:
+        content = offset_enum_start(content, f"DANCE_0_p{index}", dance_offset)
+
+    # The disabled body may hold its own #if/#endif; its block ends at the closing brace
+    hook_source = re.sub(r"^#if 0 // Disabled by oryx_to_olkb\n.*?^\}\n#endif$", "", content, flags=re.DOTALL | re.MULTILINE)
+    # Each hook this profile defines -> the #if condition around it (Oryx keeps
+    # music_mask_user under AUDIO_ENABLE), or None
+    hooks = {}
+    for hook in PROFILE_HOOKS:
+        match = re.search(r"^\w[\w \t\*]*\b" + hook + f"_p{index}" + r"\s*\([^;{]*\)\s*\{", hook_source, re.MULTILINE)
+        if match:
+            hooks[hook] = enclosing_condition(hook_source, match.start())
+    for name in sorted(names):
+        if re.search(r"_(user|kb|oryx)$", name) and name not in PROFILE_HOOKS and re.search(r"\b" + name + f"_p{index}" + r"\s*\(", hook_source):
+            print(f"Warning: profile {index}: {name} is not dispatched per profile and will not be called")
+
+    return {
+        "index": index,
+        "content": content,
+        "keymaps_block": keymaps_block,
+        "layer_offset": layer_offset,
+        "layer_count": layer_count,
+        "dance_count": dance_count,
+        "eager_entries": [rename(entry) for entry in eager_entries],
+        "tapping_term": read_tapping_term(path),
+        "hooks": hooks,
+    }
+
+def generate_profile_dispatch(profiles):
+    """olkb_profiles[] and the hook definitions that forward to the active profile."""
+    def guarded(condition, text):
+        return f"#if {condition}\n{text}#endif\n" if condition else text
+
+    hooks = [hook for hook in PROFILE_HOOKS if any(hook in profile["hooks"] for profile in profiles)]
+    if "get_tapping_term_oryx" not in hooks:
+        hooks.append("get_tapping_term_oryx")
+    # A hook exists in the build wherever any profile's #if around it holds
+    conditions = {}
+    for hook in hooks:
+        guards = [profile["hooks"].get(hook) for profile in profiles if hook in profile["hooks"]]
+        if guards and None not in guards:
+            unique = list(dict.fromkeys(guards))
+            conditions[hook] = unique[0] if len(unique) == 1 else " || ".join(f"({guard})" for guard in unique)
+        else:
+            conditions[hook] = None
+    fields = "".join(guarded(conditions[h], f"    {PROFILE_HOOKS[h][0]} (*{h})({PROFILE_HOOKS[h][1]});\n") for h in hooks)
+    entries = []
+    for profile in profiles:
+        term = profile["tapping_term"] or "TAPPING_TERM"
+        pointers = "".join(guarded(profile["hooks"][h], f"        .{h} = {h}_p{profile['index']},\n")
+                           for h in hooks if h in profile["hooks"])
+        entries.append(f"    {{\n        .first_layer  = {profile['layer_offset']},\n        .tapping_term = {term},\n{pointers}    }},")
+    out = [f"""/* Profiles packed by oryx_to_olkb.py, one per Oryx export. The profile whose
+ * layers hold the default layer is active, so PROFILE_<n> (PDF to its base
+ * layer) switches profile in one keystroke. */
+typedef struct {{
+    uint8_t  first_layer;
+    uint16_t tapping_term;
+{fields}}} olkb_profile_t;
+
+static const olkb_profile_t olkb_profiles[OLKB_PROFILE_COUNT] = {{
+{chr(10).join(entries)}
+}};
+
+static const olkb_profile_t *olkb_profile_current(void) {{
+    uint8_t layer = get_highest_layer(default_layer_state);
+    uint8_t index = OLKB_PROFILE_COUNT - 1;
+    while (index > 0 && layer < olkb_profiles[index].first_layer) {{
+        index--;
+    }}
+    return &olkb_profiles[index];
+}}
+"""]
+    for hook in hooks:
+        ret, params, args, default = PROFILE_HOOKS[hook]
+        if ret == "void":
+            body = f"    if (profile->{hook}) {{\n        profile->{hook}({args});\n    }}"
+        else:
+            body = f"    return profile->{hook} ? profile->{hook}({args}) : {default};"
+        out.append(guarded(conditions[hook], f"""{ret} {hook}({params}) {{
+    const olkb_profile_t *profile = olkb_profile_current();
+{body}
+}}
+"""))
+    return "\n".join(out)
+
+def merge_profiles(profiles):
+    """
+    Pack converted profiles into one firmware: what each profile's layers name
+    goes to keymap_layers.h (see split_preamble), layers to one keymaps[] in
+    keymap_layers.c, and the rest of the preambles, the code, one merged
+    tap_dance_actions[] and the profile dispatch to keymap.c.
+    Returns (header, layers source, keymap source, keymaps block, layer count).
+    """
+    layer_count = sum(profile["layer_count"] for profile in profiles)
+    preambles, rests, layer_rows, actions, eager_entries = [], [], [], [], []
+    actions_re = re.compile(r"^tap_dance_action_t\s+tap_dance_actions_p\d+\[\]\s*=\s*\{\n(.*?)^\};\n*", re.MULTILINE | re.DOTALL)
+    for profile in profiles:
+        content, block = profile["content"], profile["keymaps_block"]
+        start = content.index(block)
+        preamble, preamble_rest = split_preamble(content[:start].rstrip(), block)
+        preambles.append(f"/* Profile {profile['index']} */\n" + preamble)
+        rest = preamble_rest + "\n\n" + content[start + len(block):].lstrip("\n")
+        match = actions_re.search(rest)
+        if match:
+            actions.append(match.group(1).rstrip())
+            rest = rest[:match.start()] + rest[match.end():]
+        rests.append(f"/* Profile {profile['index']} */\n" + rest)
+        layer_rows.extend(block.splitlines()[1:-1])
+        eager_entries.extend(profile["eager_entries"])
+
+    switches = "".join(f"#define PROFILE_{p['index']} PDF({p['layer_offset']})\n" for p in profiles)
+    keymaps_block = "\n".join([
+        "const uint16_t PROGMEM keymaps[KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS] = {", *layer_rows, "};"])
+    header = f"""// Generated by oryx_to_olkb.py: declarations shared by keymap.c and keymap_layers.c
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+{(chr(10) * 2).join(preambles)}
+
+#define KEYMAP_LAYER_COUNT {layer_count}
+
+/* One-keystroke profile switches */
+{switches}
+extern const uint16_t PROGMEM keymaps[KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+"""
+    layers_source = f"""// Generated by oryx_to_olkb.py: keymap data (Planck Rev6 folded 8x6 matrix)
+#include "keymap_layers.h"
+
+{keymaps_block}
+"""
+    merged_actions = "tap_dance_action_t tap_dance_actions[] = {\n" + "\n".join(actions) + "\n};\n"
+    keymap_source = f"""// Converted by oryx_to_olkb.py from {len(profiles)} Oryx exports
+// Retains Vial/OLKB Matrix Compatibility
+#include "keymap_layers.h"
+
+{chr(10).join(rests)}
+{insert_eager_dance_table(merged_actions, eager_entries)}
+{generate_profile_dispatch(profiles)}"""
+    return header, layers_source, keymap_source, keymaps_block, layer_count
+
+def defined_names(text):
+    """Enum members and object-like macros a C source or header defines."""
+    names = set(re.findall(r"^\s*#\s*define\s+(\w+)", text, re.MULTILINE))
+    names.update(re.findall(r"^\s*([A-Z_][A-Z0-9_]*)\s*(?:=[^=]|,|$)", text, re.MULTILINE))
+    return names
+
+def write_preflight_keycodes(output_dir, path):
+    """
+    Write a header declaring the KC_/QK_/... names the generated sources use
+    but neither they nor scripts/qmk_stubs/ define. They are numbered from
+    QK_KB so they never alias a basic keycode.
+    """
+    sources = []
+    for name in ("keymap.c", "keymap_layers.c", "keymap_layers.h", "config.h"):
+        with open(os.path.join(output_dir, name), "r", encoding="utf-8") as f:
+            sources.append(f.read())
+    known = set()
+    for name in os.listdir(STUBS_DIR):
+        with open(os.path.join(STUBS_DIR, name), "r", encoding="utf-8") as f:
+            known |= defined_names(f.read())
+    for text in sources:
+        known |= defined_names(text)
+    extra = sorted({m for text in sources for m in PREFLIGHT_KEYCODE_RE.findall(text)} - known)
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("#pragma once\n")
+        if extra:
+            f.write(f"enum preflight_keycodes {{ {extra[0]} = 0x7E00, " + ", ".join(extra[1:]) + " };\n")
+
+def stub_compile_flags(output_dir, rules_path, keycodes_header):
+    """
+    Host compiler flags for building generated sources against scripts/qmk_stubs/:
+    the QMK feature flags the generated rules.mk turns on, config.h and the
+    header from write_preflight_keycodes().
+    """
+    with open(rules_path, "r", encoding="utf-8") as f:
+        flags = re.findall(r"^(\w+_ENABLE) = yes$", f.read(), re.MULTILINE)
+    if "VIAL_ENABLE" in flags:
+        flags.append("VIA_ENABLE")
+    output_dir = os.path.abspath(output_dir)
+    return ["-std=gnu11", "-DQMK_KEYBOARD_H=\"quantum.h\"", *(f"-D{flag}" for flag in flags),
+            "-I", output_dir, "-I", STUBS_DIR,
+            "-include", os.path.join(output_dir, "config.h"), "-include", keycodes_header]
+
+def preflight_units(output_dir, flags):
+    """(name, path) of each source the pre-flight compiles, given the enabled flags."""
+    output_dir = os.path.abspath(output_dir)
+    # keymap_layers.c goes through the introspection wrapper, as in QMK
+    units = [("keymap.c", os.path.join(output_dir, "keymap.c")),
+             ("keymap_layers.c", os.path.join(STUBS_DIR, "keymap_introspection.c")),
+             ("olkb_hooks.c", os.path.join(output_dir, "olkb_hooks.c")),
+             ("olkb_hid.c", os.path.join(output_dir, "olkb_hid.c"))]
+    for flag, _, sources, _ in FEATURE_MODULES:
+        if flag in flags:
+            units.extend((src, os.path.join(output_dir, src)) for src in sources + GENERATED_SOURCES.get(flag, [])
+                         if src.endswith(".c") and src not in MCU_MODULE_SOURCES)
+    return units
+
+def preflight_compile(output_dir, rules_path):
+    """
+    Syntax-check keymap.c, keymap_layers.c, the hook dispatcher and the enabled
+    modules that build without MCU headers against scripts/qmk_stubs/ with the
+    host compiler, using the feature flags the generated rules.mk turns on.
+    keymap.c is checked again with the features in PREFLIGHT_OPTIONAL_FLAGS
+    off. Returns False if any fails; a missing compiler skips the check.
+    """
+    compiler = shutil.which(os.environ.get("CC", "cc"))
+    if compiler is None:
+        print(" - Pre-flight compile skipped (no host C compiler; set CC)")
+        return True
+
+    with tempfile.TemporaryDirectory() as scratch:
+        keycodes_header = os.path.join(scratch, "preflight_keycodes.h")
+        write_preflight_keycodes(output_dir, keycodes_header)
+        flags = stub_compile_flags(output_dir, rules_path, keycodes_header)
+        command = [compiler, "-fsyntax-only",
+                   "-Werror=implicit-function-declaration", "-Werror=incompatible-pointer-types",
+                   "-Werror=int-conversion", "-Werror=return-type", *flags]
+        enabled = {flag[2:] for flag in flags if flag.startswith("-D")}
+        units = [(name, command + [path]) for name, path in preflight_units(output_dir, enabled)]
+        optional = [flag for flag in PREFLIGHT_OPTIONAL_FLAGS if flag in enabled]
+        if optional:
+            units.append((f"keymap.c without {', '.join(optional)}",
+                          command + [f"-U{flag}" for flag in optional] + [os.path.join(os.path.abspath(output_dir), "keymap.c")]))
+        ok = True
+        for name, unit_command in units:
+            result = subprocess.run(unit_command, capture_output=True, text=True)
+            if result.returncode != 0:
+                ok = False
+                print(f"Error: pre-flight compile of {name} failed:")
+                print(result.stderr.rstrip())
+            elif result.stderr.strip():
+                print(f"Warning: pre-flight compile of {name}:")
+                print(result.stderr.rstrip())
+    if ok:
+        print(f" ✓ Pre-flight compile passed ({len(units)} units)")
+    return ok
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert ZSA Oryx keymap exports to a Planck Rev6 Vial keymap.")
+    parser.add_argument("exports", nargs="*", default=[INPUT_FILE],
+                        help="Oryx keymap.c files; more than one builds a multi-profile firmware "
+                             f"(default: {INPUT_FILE})")
+    parser.add_argument("--no-preflight", action="store_true",
+                        help="skip the host syntax check of the generated keymap against scripts/qmk_stubs/")
+    args = parser.parse_args()
+
+    for path in args.exports:
+        if not os.path.exists(path):
+            print(f"Error: Input file '{path}' not found.")
+            print("Place your ZSA 'keymap.c' in the 'zsa_oryx_source' folder.")
+            sys.exit(1)
+
+    if len(args.exports) == 1:
+        print(f"Reading from {args.exports[0]}...")
+        with open(args.exports[0], "r", encoding="utf-8") as f:
+            content = f.read()
+
+        new_content, keymaps_block, layer_count = convert_keymap_source(content)
+        header, layers_source, keymap_source = split_keymap_layers(new_content, keymaps_block, layer_count)
+    else:
+        profiles = []
+        layer_offset = dance_offset = 0
+        for index, path in enumerate(args.exports):
+            profile = prepare_profile(path, index, layer_offset, dance_offset)
+            profiles.append(profile)
+            layer_offset += profile["layer_count"]
+            dance_offset += profile["dance_count"]
+        if layer_offset > 32:
+            print(f"Error: {layer_offset} layers across all profiles; QMK supports at most 32.")
+            sys.exit(1)
+        header, layers_source, keymap_source, keymaps_block, layer_count = merge_profiles(profiles)
+        print(f"Packed {len(profiles)} profiles: {layer_count} layers, {dance_offset} dances")
+
     os.makedirs(OUTPUT_DIR, exist_ok=True)
 
-    with open(OUTPUT_KEYMAP, "w", encoding="utf-8") as f:
-        f.write(f"// Converted by oryx_to_olkb.py\\n// Retains Vial/OLKB Matrix Compatibility\\n{new_content}")
-    print(f" ✓ Generated keymap.c")
+    for path, source in ((OUTPUT_LAYERS_H, header), (OUTPUT_LAYERS_C, layers_source), (OUTPUT_KEYMAP, keymap_source)):
+        name = os.path.basename(path)
+        print(f" ✓ Generated {name}" if write_if_changed(path, source) else f" ✓ {name} unchanged")
+
+    # Text expansion dictionary (optional mapping file next to the Oryx export)
+    expansions = parse_expansions(EXPANSIONS_FILE)
+    generate_text_expansion_data(OUTPUT_DIR, expansions)
 
     # Generate rules.mk
-    generate_rules_mk(OUTPUT_RULES)
+    generate_rules_mk(OUTPUT_RULES, {
+        "TEXT_EXPANSION_ENABLE": bool(expansions),
+        "KINETIC_MOUSE_ENABLE": bool(MOUSE_CURSOR_RE.search(keymaps_block)),
+    })
 
     # Generate config.h
-    generate_config_h(OUTPUT_CONFIG)
+    oryx_hooks = [hook for hook in ORYX_PER_KEY_HOOKS if re.search(r"\b" + hook + r"_oryx\s*\(", keymap_source)]
+    tapping_term = read_tapping_term(args.exports[0]) if len(args.exports) == 1 else None
+    generate_config_h(OUTPUT_CONFIG, len(args.exports), layer_count, oryx_hooks, tapping_term)
     
     # Generate vial.json
     generate_vial_json(OUTPUT_VIAL_JSON)
 
-    print("\\n" + "=" * 50)
-    print(" SUCCESS! Generated 4 files in 'olkb_firmware/':")
-    print(" - keymap.c")
+    # Copy firmware modules
+    copy_modules(OUTPUT_DIR)
+
+    # Catch type and signature errors now rather than at the end of qmk compile
+    if not args.no_preflight and not preflight_compile(OUTPUT_DIR, OUTPUT_RULES):
+        sys.exit(1)
+
+    print("\n" + "=" * 50)
+    print(" SUCCESS! Generated files in 'olkb_firmware/':")
+    print(" - keymap.c, keymap_layers.c/.h")
     print(" - rules.mk")
     print(" - config.h")
     print(" - vial.json")
-    print("\\n" + "=" * 50)
+    print(" - olkb_hooks.c/.h and feature modules")
+    print("\n" + "=" * 50)
     print(" ACTION REQUIRED:")
-    print(" 1. Copy 'keymap.c', 'rules.mk', 'config.h' to your QMK keymap folder:")
-    print("    cp olkb_firmware/*.c olkb_firmware/*.mk olkb_firmware/*.h qmk_firmware/keyboards/planck/keymaps/vial/")
+    print(" 1. Copy the build files to your QMK keymap folder (-p keeps mtimes for incremental builds):")
+    print("    cp -p olkb_firmware/*.c olkb_firmware/*.mk olkb_firmware/*.h qmk_firmware/keyboards/planck/keymaps/vial/")
     print(" 2. Sideload 'vial.json' in the Vial app if automatic detection fails.")
-    print("\\n Then compile with:")
+    print("\n Then compile with:")
     print(" qmk compile -kb planck/rev6 -km vial")
     print("=" * 50)
 
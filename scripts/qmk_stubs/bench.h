@@ -0,0 +1,12 @@
+#pragma once
+
+/*
+ * Interface between bench_main.c and the cases olkb_bench.py generates for
+ * a converted keymap. Each case is one call unit timed in a tight loop.
+ */
+typedef void (*bench_fn_t)(void *arg);
+
+void bench_add(const char *name, bench_fn_t run, void *arg);
+
+/* Generated: registers every case with bench_add() */
+void bench_cases_init(void);
@@ -0,0 +1,148 @@
+/*
+ * Timing harness for scripts/olkb_bench.py. Runs every registered case in a
+ * tight loop and prints one tab-separated line per case:
+ *   name, calls, ns per call, cycles per call, instructions per call
+ * Cycles and instructions come from Linux perf_event_open hardware counters
+ * (user space only); where those are unavailable (other OSes, containers,
+ * perf_event_paranoid) they print as -1 and only clock_gettime time is kept.
+ */
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+#include "bench.h"
+
+#define BENCH_MAX_CASES 512
+#define BENCH_REPEATS 3
+
+typedef struct {
+    const char *name;
+    bench_fn_t  run;
+    void       *arg;
+} bench_case_t;
+
+static bench_case_t cases[BENCH_MAX_CASES];
+static unsigned     case_count;
+
+void bench_add(const char *name, bench_fn_t run, void *arg) {
+    if (case_count < BENCH_MAX_CASES) {
+        cases[case_count++] = (bench_case_t){name, run, arg};
+    }
+}
+
+static int perf_leader = -1;
+static int perf_member = -1;
+
+#ifdef __linux__
+static int perf_open(uint64_t config, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+static void perf_init(void) {
+#ifdef __linux__
+    perf_leader = perf_open(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (perf_leader < 0) {
+        return;
+    }
+    perf_member = perf_open(PERF_COUNT_HW_INSTRUCTIONS, perf_leader);
+    if (perf_member < 0) {
+        close(perf_leader);
+        perf_leader = -1;
+    }
+#endif
+}
+
+static void perf_start(void) {
+#ifdef __linux__
+    if (perf_leader >= 0) {
+        ioctl(perf_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+static void perf_stop(int64_t *cycles, int64_t *instructions) {
+    *cycles       = -1;
+    *instructions = -1;
+#ifdef __linux__
+    if (perf_leader >= 0) {
+        struct {
+            uint64_t nr;
+            uint64_t values[2];
+        } group;
+        ioctl(perf_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(perf_leader, &group, sizeof(group)) == (ssize_t)sizeof(group)) {
+            *cycles       = (int64_t)group.values[0];
+            *instructions = (int64_t)group.values[1];
+        }
+    }
+#endif
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_empty(void *arg) {}
+
+int main(int argc, char **argv) {
+    unsigned long calls = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000UL;
+    if (calls == 0) {
+        calls = 1;
+    }
+    perf_init();
+    printf("counters\t%s\n", perf_leader >= 0 ? "perf" : "clock");
+
+    /* Harness cost of one indirect call, to subtract from the others */
+    bench_add("empty", bench_empty, NULL);
+    bench_cases_init();
+
+    for (unsigned i = 0; i < case_count; i++) {
+        bench_case_t *bench = &cases[i];
+        for (unsigned long n = 0; n < calls / 16; n++) {
+            bench->run(bench->arg);
+        }
+        /* Keep the quietest of a few runs */
+        uint64_t best_ns     = UINT64_MAX;
+        int64_t  best_cycles = -1, best_instructions = -1;
+        for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+            int64_t  cycles, instructions;
+            uint64_t started = now_ns();
+            perf_start();
+            for (unsigned long n = 0; n < calls; n++) {
+                bench->run(bench->arg);
+            }
+            perf_stop(&cycles, &instructions);
+            uint64_t elapsed = now_ns() - started;
+            if (elapsed < best_ns) {
+                best_ns           = elapsed;
+                best_cycles       = cycles;
+                best_instructions = instructions;
+            }
+        }
+        printf("%s\t%lu\t%.3f\t%.3f\t%.3f\n", bench->name, calls, (double)best_ns / calls,
+               best_cycles < 0 ? -1.0 : (double)best_cycles / calls,
+               best_instructions < 0 ? -1.0 : (double)best_instructions / calls);
+    }
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+uint8_t dynamic_keymap_get_layer_count(void);
+void    dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data);
+void    dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data);
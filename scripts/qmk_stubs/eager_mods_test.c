@@ -0,0 +1,87 @@
+/*
+ * Host test for olkb_modules/eager_mods.c: the modifier a dance or MT()
+ * key puts down on press must be gone from the host's last report once the
+ * key resolves as a tap, even when that tap sends no key of its own.
+ * Follows the reports through host_shim.c, so no generated keymap is needed:
+ *
+ *   cc -std=gnu11 -Iscripts/qmk_stubs -Iscripts/olkb_modules \
+ *      scripts/qmk_stubs/eager_mods_test.c scripts/olkb_modules/eager_mods.c \
+ *      scripts/qmk_stubs/host_shim.c -o eager_mods_test && ./eager_mods_test
+ */
+#include "eager_mods.h"
+#include <stdio.h>
+
+/* DANCE_0 holds to Left Ctrl, DANCE_1 has no modifier hold */
+const uint8_t PROGMEM eager_dance_mods[] = {MOD_BIT(KC_LEFT_CTRL), 0};
+const uint8_t eager_dance_mods_count = sizeof(eager_dance_mods);
+
+/* The host_shim.c clock and report hook */
+void host_shim_set_ms(uint32_t ms);
+extern void (*host_shim_report_hook)(uint8_t mods, const uint8_t *keys);
+
+/* What host_shim.c otherwise takes from a generated keymap */
+layer_state_t layer_state_set_user(layer_state_t state) {
+    return state;
+}
+
+uint8_t keymap_layer_count(void) {
+    return 1;
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    return KC_NO;
+}
+
+static uint8_t host_mods;
+static uint8_t host_key;
+static int     failures;
+
+static void on_report(uint8_t mods, const uint8_t *keys) {
+    host_mods = mods;
+    host_key  = keys[0];
+}
+
+static keyrecord_t press_at(uint16_t keycode, uint16_t ms) {
+    host_shim_set_ms(ms);
+    keyrecord_t record = {.event = {.key = {.row = 0, .col = 0}, .time = ms, .type = KEY_EVENT, .pressed = true}};
+    eager_mods_record(keycode, &record);
+    return record;
+}
+
+static void expect(const char *what, uint8_t got, uint8_t want) {
+    if (got != want) {
+        printf("FAIL %s: 0x%02X, expected 0x%02X\n", what, got, want);
+        failures++;
+    } else {
+        printf("ok   %s: 0x%02X\n", what, got);
+    }
+}
+
+int main(void) {
+    host_shim_report_hook = on_report;
+
+    /* Dance press: Ctrl reaches the host at once */
+    press_at(TD(0), 1000);
+    expect("dance press", host_mods, MOD_BIT(KC_LEFT_CTRL));
+
+    /* Resolved as a tap step with no action: nothing else is sent, Ctrl must still be released */
+    eager_mods_dance_resolve(0, false);
+    expect("dance tap sending no key", host_mods, 0);
+
+    /* Second press of the dance retracts the modifier before any multi-tap */
+    press_at(TD(0), 2000);
+    press_at(TD(0), 2050);
+    expect("second dance press", host_mods, 0);
+    eager_mods_dance_resolve(0, false);
+
+    /* MT() tap: the tap key's own report carries no modifier */
+    keyrecord_t record = press_at(MT(MOD_LSFT, KC_A), 3000);
+    expect("MT() press", host_mods, MOD_BIT(KC_LEFT_SHIFT));
+    record.tap.count = 1;
+    eager_mods_process(MT(MOD_LSFT, KC_A), &record);
+    register_code(KC_A);
+    expect("MT() tap modifiers", host_mods, 0);
+    expect("MT() tap key", host_key, KC_A);
+
+    return failures ? 1 : 0;
+}
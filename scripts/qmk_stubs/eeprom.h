@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+
+uint8_t  eeprom_read_byte(const uint8_t *addr);
+void     eeprom_update_byte(uint8_t *addr, uint8_t value);
+uint32_t eeprom_read_dword(const uint32_t *addr);
+void     eeprom_update_dword(uint32_t *addr, uint32_t value);
@@ -0,0 +1,385 @@
+/*
+ * Host implementations of the QMK calls declared in the stubs, for linking
+ * a generated keymap into scripts/olkb_bench.py's benchmark. Waits are
+ * dropped; modifier, layer, timer and keyboard report state behave like
+ * QMK's so keymap code takes the same branches it would on the keyboard.
+ * A host test can set host_shim_report_hook to follow the reports sent.
+ */
+#include "quantum.h"
+#include "eeprom.h"
+#include "muse.h"
+
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+static uint8_t  real_mods;
+static uint8_t  weak_mods;
+static uint8_t  oneshot_mods;
+static uint32_t host_ms;
+static bool     caps_word;
+
+/* Sink so sent keycodes are not optimised away */
+volatile uint16_t host_shim_last_keycode;
+
+/* Called with each keyboard report QMK would send; NULL for the benchmark */
+void (*host_shim_report_hook)(uint8_t mods, const uint8_t *keys);
+
+static uint8_t report_keys[6];
+
+/* 5-bit QK_MODS encoding to MOD_BIT()s: bit 4 selects the right-hand modifiers */
+static uint8_t mod_bits(uint8_t mods) {
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods & 0x0F;
+}
+
+static void report_key(uint8_t kc, bool pressed) {
+    for (uint8_t i = 0; i < sizeof(report_keys); i++) {
+        if (report_keys[i] == (pressed ? 0 : kc)) {
+            report_keys[i] = pressed ? kc : 0;
+            return;
+        }
+    }
+}
+
+void send_keyboard_report(void) {
+    if (host_shim_report_hook) {
+        host_shim_report_hook(real_mods | weak_mods, report_keys);
+    }
+}
+
+void register_code(uint8_t kc) {
+    host_shim_last_keycode = kc;
+    if (kc >= KC_LEFT_CTRL && kc <= KC_RIGHT_GUI) {
+        real_mods |= MOD_BIT(kc);
+    } else if (kc) {
+        report_key(kc, true);
+    }
+    send_keyboard_report();
+}
+
+void unregister_code(uint8_t kc) {
+    host_shim_last_keycode = kc;
+    if (kc >= KC_LEFT_CTRL && kc <= KC_RIGHT_GUI) {
+        real_mods &= ~MOD_BIT(kc);
+    } else if (kc) {
+        report_key(kc, false);
+    }
+    send_keyboard_report();
+}
+
+void tap_code(uint8_t kc) {
+    register_code(kc);
+    unregister_code(kc);
+}
+
+void tap_code_delay(uint8_t kc, uint16_t delay) {
+    tap_code(kc);
+}
+
+/* action.c: a modded keycode's modifiers go out as weak mods, in their own report */
+void register_code16(uint16_t kc) {
+    uint8_t mods = mod_bits((kc >> 8) & 0x1F);
+    if (mods) {
+        weak_mods |= mods;
+        send_keyboard_report();
+    }
+    register_code(kc & 0xFF);
+}
+
+void unregister_code16(uint16_t kc) {
+    uint8_t mods = mod_bits((kc >> 8) & 0x1F);
+    unregister_code(kc & 0xFF);
+    if (mods) {
+        weak_mods &= ~mods;
+        send_keyboard_report();
+    }
+}
+
+void tap_code16(uint16_t kc) {
+    register_code16(kc);
+    unregister_code16(kc);
+}
+
+void tap_code16_delay(uint16_t kc, uint16_t delay) {
+    tap_code16(kc);
+}
+
+void clear_keyboard(void) {
+    real_mods = weak_mods = 0;
+    memset(report_keys, 0, sizeof(report_keys));
+}
+
+uint8_t get_mods(void) {
+    return real_mods;
+}
+
+void set_mods(uint8_t mods) {
+    real_mods = mods;
+}
+
+void add_mods(uint8_t mods) {
+    real_mods |= mods;
+}
+
+void del_mods(uint8_t mods) {
+    real_mods &= ~mods;
+}
+
+void clear_mods(void) {
+    real_mods = 0;
+}
+
+void register_mods(uint8_t mods) {
+    add_mods(mods);
+}
+
+void unregister_mods(uint8_t mods) {
+    del_mods(mods);
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void add_weak_mods(uint8_t mods) {
+    weak_mods |= mods;
+}
+
+void del_weak_mods(uint8_t mods) {
+    weak_mods &= ~mods;
+}
+
+void clear_weak_mods(void) {
+    weak_mods = 0;
+}
+
+uint8_t get_oneshot_mods(void) {
+    return oneshot_mods;
+}
+
+void set_oneshot_mods(uint8_t mods) {
+    oneshot_mods = mods;
+}
+
+void add_oneshot_mods(uint8_t mods) {
+    oneshot_mods |= mods;
+}
+
+void del_oneshot_mods(uint8_t mods) {
+    oneshot_mods &= ~mods;
+}
+
+void clear_oneshot_mods(void) {
+    oneshot_mods = 0;
+}
+
+void set_oneshot_layer(uint8_t layer, uint8_t state) {}
+
+void clear_oneshot_layer_state(uint8_t state) {}
+
+void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_clear(void) {
+    layer_state_set(0);
+}
+
+void layer_move(uint8_t layer) {
+    layer_state_set((layer_state_t)1 << layer);
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | ((layer_state_t)1 << layer));
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+void layer_invert(uint8_t layer) {
+    layer_state_set(layer_state ^ ((layer_state_t)1 << layer));
+}
+
+bool layer_state_cmp(layer_state_t state, uint8_t layer) {
+    if (!state) {
+        return layer == 0;
+    }
+    return (state & ((layer_state_t)1 << layer)) != 0;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state_cmp(layer_state, layer);
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    uint8_t layer = 0;
+    while (state >>= 1) {
+        layer++;
+    }
+    return layer;
+}
+
+void default_layer_set(layer_state_t state) {
+    default_layer_state = state;
+}
+
+void set_single_persistent_default_layer(uint8_t default_layer) {
+    default_layer_set((layer_state_t)1 << default_layer);
+}
+
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3) {
+    layer_state_t mask12 = ((layer_state_t)1 << layer1) | ((layer_state_t)1 << layer2);
+    layer_state_t mask3  = (layer_state_t)1 << layer3;
+    return (state & mask12) == mask12 ? (state | mask3) : (state & ~mask3);
+}
+
+void update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3) {
+    layer_state_set(update_tri_layer_state(layer_state, layer1, layer2, layer3));
+}
+
+/* The benchmark advances this clock itself */
+void host_shim_set_ms(uint32_t ms) {
+    host_ms = ms;
+}
+
+uint16_t timer_read(void) {
+    return (uint16_t)host_ms;
+}
+
+uint32_t timer_read32(void) {
+    return host_ms;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return host_ms - last;
+}
+
+void wait_ms(uint32_t ms) {}
+
+void wait_us(uint32_t us) {}
+
+void send_string(const char *string) {
+    while (*string) {
+        send_char(*string++);
+    }
+}
+
+void send_string_with_delay(const char *string, uint8_t interval) {
+    send_string(string);
+}
+
+void send_char(char ascii_code) {
+    host_shim_last_keycode = (uint8_t)ascii_code;
+}
+
+matrix_row_t matrix_get_row(uint8_t row) {
+    return 0;
+}
+
+void reset_keyboard(void) {}
+
+void soft_reset_keyboard(void) {}
+
+void eeconfig_init(void) {}
+
+void raw_hid_send(uint8_t *data, uint8_t length) {}
+
+bool is_caps_word_on(void) {
+    return caps_word;
+}
+
+void caps_word_on(void) {
+    caps_word = true;
+}
+
+void caps_word_off(void) {
+    caps_word = false;
+}
+
+void caps_word_toggle(void) {
+    caps_word = !caps_word;
+}
+
+void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {}
+
+void stop_all_notes(void) {}
+
+void stop_note(float freq) {}
+
+void play_note(float freq, int vol) {}
+
+float compute_freq_for_midi_note(uint8_t note) {
+    return 440.0f;
+}
+
+bool is_audio_on(void) {
+    return false;
+}
+
+bool is_music_on(void) {
+    return false;
+}
+
+void music_on(void) {}
+
+void music_off(void) {}
+
+report_mouse_t mousekey_get_report(void) {
+    report_mouse_t report = {0};
+    return report;
+}
+
+void host_mouse_send(report_mouse_t *report) {}
+
+void tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data) {}
+
+void tap_dance_pair_finished(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    register_code16(state->count == 1 ? pair->kc1 : pair->kc2);
+}
+
+void tap_dance_pair_reset(tap_dance_state_t *state, void *user_data) {
+    tap_dance_pair_t *pair = (tap_dance_pair_t *)user_data;
+    unregister_code16(state->count == 1 ? pair->kc1 : pair->kc2);
+}
+
+void reset_tap_dance(tap_dance_state_t *state) {
+    state->count    = 0;
+    state->pressed  = false;
+    state->finished = false;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+    return 0;
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) {}
+
+uint32_t eeprom_read_dword(const uint32_t *addr) {
+    return 0;
+}
+
+void eeprom_update_dword(uint32_t *addr, uint32_t value) {}
+
+uint8_t SCALE[] = {0};
+
+uint8_t muse_clock_pulse(void) {
+    return 0;
+}
+
+/* action_layer.c: the highest active layer that maps the key to something */
+uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    for (int8_t layer = MAX_LAYER - 1; layer >= 0; layer--) {
+        if ((layers & ((layer_state_t)1 << layer)) && layer < (int8_t)keymap_layer_count()) {
+            if (keymap_key_to_keycode(layer, key) != KC_TRANSPARENT) {
+                return layer;
+            }
+        }
+    }
+    return 0;
+}
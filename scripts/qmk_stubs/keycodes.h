@@ -0,0 +1,397 @@
+#pragma once
+
+/*
+ * QMK keycode ranges, the basic keycodes and the keycode macros Oryx exports
+ * use. Any other KC_/QK_/RGB_/... name a keymap uses is declared by the
+ * pre-flight itself, so these lists do not have to be complete.
+ */
+enum qk_keycode_ranges {
+    QK_BASIC                = 0x0000,
+    QK_MODS                 = 0x0100,
+    QK_MOD_TAP              = 0x2000,
+    QK_MOD_TAP_MAX          = 0x3FFF,
+    QK_LAYER_TAP            = 0x4000,
+    QK_LAYER_TAP_MAX        = 0x4FFF,
+    QK_LAYER_MOD            = 0x5000,
+    QK_TO                   = 0x5200,
+    QK_MOMENTARY            = 0x5220,
+    QK_DEF_LAYER            = 0x5240,
+    QK_TOGGLE_LAYER         = 0x5260,
+    QK_ONE_SHOT_LAYER       = 0x5280,
+    QK_ONE_SHOT_MOD         = 0x52A0,
+    QK_LAYER_TAP_TOGGLE     = 0x52C0,
+    QK_PERSISTENT_DEF_LAYER = 0x52E0,
+    QK_SWAP_HANDS           = 0x5600,
+    QK_TAP_DANCE            = 0x5700,
+    QK_TAP_DANCE_MAX        = 0x57FF,
+    QK_MAGIC                = 0x7000,
+    QK_AUDIO                = 0x7480,
+    QK_MACRO                = 0x7700,
+    QK_LIGHTING             = 0x7800,
+    QK_QUANTUM              = 0x7C00,
+    QK_KB                   = 0x7E00,
+    QK_USER                 = 0x7E40,
+    SAFE_RANGE              = QK_USER,
+};
+
+enum qk_keycodes {
+    KC_NO              = 0x0000,
+    KC_TRANSPARENT     = 0x0001,
+    KC_A               = 0x0004,
+    KC_B               = 0x0005,
+    KC_C               = 0x0006,
+    KC_D               = 0x0007,
+    KC_E               = 0x0008,
+    KC_F               = 0x0009,
+    KC_G               = 0x000A,
+    KC_H               = 0x000B,
+    KC_I               = 0x000C,
+    KC_J               = 0x000D,
+    KC_K               = 0x000E,
+    KC_L               = 0x000F,
+    KC_M               = 0x0010,
+    KC_N               = 0x0011,
+    KC_O               = 0x0012,
+    KC_P               = 0x0013,
+    KC_Q               = 0x0014,
+    KC_R               = 0x0015,
+    KC_S               = 0x0016,
+    KC_T               = 0x0017,
+    KC_U               = 0x0018,
+    KC_V               = 0x0019,
+    KC_W               = 0x001A,
+    KC_X               = 0x001B,
+    KC_Y               = 0x001C,
+    KC_Z               = 0x001D,
+    KC_1               = 0x001E,
+    KC_2               = 0x001F,
+    KC_3               = 0x0020,
+    KC_4               = 0x0021,
+    KC_5               = 0x0022,
+    KC_6               = 0x0023,
+    KC_7               = 0x0024,
+    KC_8               = 0x0025,
+    KC_9               = 0x0026,
+    KC_0               = 0x0027,
+    KC_ENTER           = 0x0028,
+    KC_ESCAPE          = 0x0029,
+    KC_BACKSPACE       = 0x002A,
+    KC_TAB             = 0x002B,
+    KC_SPACE           = 0x002C,
+    KC_MINUS           = 0x002D,
+    KC_EQUAL           = 0x002E,
+    KC_LEFT_BRACKET    = 0x002F,
+    KC_RIGHT_BRACKET   = 0x0030,
+    KC_BACKSLASH       = 0x0031,
+    KC_NONUS_HASH      = 0x0032,
+    KC_SEMICOLON       = 0x0033,
+    KC_QUOTE           = 0x0034,
+    KC_GRAVE           = 0x0035,
+    KC_COMMA           = 0x0036,
+    KC_DOT             = 0x0037,
+    KC_SLASH           = 0x0038,
+    KC_CAPS_LOCK       = 0x0039,
+    KC_F1              = 0x003A,
+    KC_F2              = 0x003B,
+    KC_F3              = 0x003C,
+    KC_F4              = 0x003D,
+    KC_F5              = 0x003E,
+    KC_F6              = 0x003F,
+    KC_F7              = 0x0040,
+    KC_F8              = 0x0041,
+    KC_F9              = 0x0042,
+    KC_F10             = 0x0043,
+    KC_F11             = 0x0044,
+    KC_F12             = 0x0045,
+    KC_PRINT_SCREEN    = 0x0046,
+    KC_SCROLL_LOCK     = 0x0047,
+    KC_PAUSE           = 0x0048,
+    KC_INSERT          = 0x0049,
+    KC_HOME            = 0x004A,
+    KC_PAGE_UP         = 0x004B,
+    KC_DELETE          = 0x004C,
+    KC_END             = 0x004D,
+    KC_PAGE_DOWN       = 0x004E,
+    KC_RIGHT           = 0x004F,
+    KC_LEFT            = 0x0050,
+    KC_DOWN            = 0x0051,
+    KC_UP              = 0x0052,
+    KC_NUM_LOCK        = 0x0053,
+    KC_KP_SLASH        = 0x0054,
+    KC_KP_ASTERISK     = 0x0055,
+    KC_KP_MINUS        = 0x0056,
+    KC_KP_PLUS         = 0x0057,
+    KC_KP_ENTER        = 0x0058,
+    KC_KP_1            = 0x0059,
+    KC_KP_2            = 0x005A,
+    KC_KP_3            = 0x005B,
+    KC_KP_4            = 0x005C,
+    KC_KP_5            = 0x005D,
+    KC_KP_6            = 0x005E,
+    KC_KP_7            = 0x005F,
+    KC_KP_8            = 0x0060,
+    KC_KP_9            = 0x0061,
+    KC_KP_0            = 0x0062,
+    KC_KP_DOT          = 0x0063,
+    KC_NONUS_BACKSLASH = 0x0064,
+    KC_APPLICATION     = 0x0065,
+    KC_KP_EQUAL        = 0x0067,
+    KC_F13             = 0x0068,
+    KC_F14             = 0x0069,
+    KC_F15             = 0x006A,
+    KC_F16             = 0x006B,
+    KC_F17             = 0x006C,
+    KC_F18             = 0x006D,
+    KC_F19             = 0x006E,
+    KC_F20             = 0x006F,
+    KC_F21             = 0x0070,
+    KC_F22             = 0x0071,
+    KC_F23             = 0x0072,
+    KC_F24             = 0x0073,
+    KC_KP_COMMA        = 0x0085,
+    KC_AUDIO_MUTE      = 0x00A8,
+    KC_AUDIO_VOL_UP    = 0x00A9,
+    KC_AUDIO_VOL_DOWN  = 0x00AA,
+    KC_MEDIA_NEXT_TRACK = 0x00AB,
+    KC_MEDIA_PREV_TRACK = 0x00AC,
+    KC_MEDIA_STOP      = 0x00AD,
+    KC_MEDIA_PLAY_PAUSE = 0x00AE,
+    KC_BRIGHTNESS_UP   = 0x00BD,
+    KC_BRIGHTNESS_DOWN = 0x00BE,
+    KC_LEFT_CTRL       = 0x00E0,
+    KC_LEFT_SHIFT      = 0x00E1,
+    KC_LEFT_ALT        = 0x00E2,
+    KC_LEFT_GUI        = 0x00E3,
+    KC_RIGHT_CTRL      = 0x00E4,
+    KC_RIGHT_SHIFT     = 0x00E5,
+    KC_RIGHT_ALT       = 0x00E6,
+    KC_RIGHT_GUI       = 0x00E7,
+    QK_BOOT            = 0x7C00,
+    QK_REBOOT          = 0x7C01,
+    QK_CLEAR_EEPROM    = 0x7C03,
+    QK_AUDIO_ON        = 0x7480,
+    QK_AUDIO_OFF       = 0x7481,
+    QK_AUDIO_TOGGLE    = 0x7482,
+    QK_MUSIC_ON        = 0x7490,
+    QK_MUSIC_OFF       = 0x7491,
+    QK_MUSIC_TOGGLE    = 0x7492,
+    QK_CAPS_WORD_TOGGLE = 0x7C73,
+};
+
+/* Short names */
+#define XXXXXXX KC_NO
+#define _______ KC_TRANSPARENT
+#define KC_TRNS KC_TRANSPARENT
+#define KC_ENT KC_ENTER
+#define KC_ESC KC_ESCAPE
+#define KC_BSPC KC_BACKSPACE
+#define KC_SPC KC_SPACE
+#define KC_MINS KC_MINUS
+#define KC_EQL KC_EQUAL
+#define KC_LBRC KC_LEFT_BRACKET
+#define KC_RBRC KC_RIGHT_BRACKET
+#define KC_BSLS KC_BACKSLASH
+#define KC_NUHS KC_NONUS_HASH
+#define KC_SCLN KC_SEMICOLON
+#define KC_QUOT KC_QUOTE
+#define KC_GRV KC_GRAVE
+#define KC_COMM KC_COMMA
+#define KC_SLSH KC_SLASH
+#define KC_CAPS KC_CAPS_LOCK
+#define KC_PSCR KC_PRINT_SCREEN
+#define KC_SCRL KC_SCROLL_LOCK
+#define KC_PAUS KC_PAUSE
+#define KC_INS KC_INSERT
+#define KC_PGUP KC_PAGE_UP
+#define KC_DEL KC_DELETE
+#define KC_PGDN KC_PAGE_DOWN
+#define KC_RGHT KC_RIGHT
+#define KC_NUM KC_NUM_LOCK
+#define KC_PSLS KC_KP_SLASH
+#define KC_PAST KC_KP_ASTERISK
+#define KC_PMNS KC_KP_MINUS
+#define KC_PPLS KC_KP_PLUS
+#define KC_PENT KC_KP_ENTER
+#define KC_P1 KC_KP_1
+#define KC_P2 KC_KP_2
+#define KC_P3 KC_KP_3
+#define KC_P4 KC_KP_4
+#define KC_P5 KC_KP_5
+#define KC_P6 KC_KP_6
+#define KC_P7 KC_KP_7
+#define KC_P8 KC_KP_8
+#define KC_P9 KC_KP_9
+#define KC_P0 KC_KP_0
+#define KC_PDOT KC_KP_DOT
+#define KC_NUBS KC_NONUS_BACKSLASH
+#define KC_APP KC_APPLICATION
+#define KC_PEQL KC_KP_EQUAL
+#define KC_PCMM KC_KP_COMMA
+#define KC_MUTE KC_AUDIO_MUTE
+#define KC_VOLU KC_AUDIO_VOL_UP
+#define KC_VOLD KC_AUDIO_VOL_DOWN
+#define KC_MNXT KC_MEDIA_NEXT_TRACK
+#define KC_MPRV KC_MEDIA_PREV_TRACK
+#define KC_MSTP KC_MEDIA_STOP
+#define KC_MPLY KC_MEDIA_PLAY_PAUSE
+#define KC_BRIU KC_BRIGHTNESS_UP
+#define KC_BRID KC_BRIGHTNESS_DOWN
+#define KC_LCTL KC_LEFT_CTRL
+#define KC_LSFT KC_LEFT_SHIFT
+#define KC_LALT KC_LEFT_ALT
+#define KC_LOPT KC_LEFT_ALT
+#define KC_LGUI KC_LEFT_GUI
+#define KC_LCMD KC_LEFT_GUI
+#define KC_RCTL KC_RIGHT_CTRL
+#define KC_RSFT KC_RIGHT_SHIFT
+#define KC_RALT KC_RIGHT_ALT
+#define KC_ROPT KC_RIGHT_ALT
+#define KC_ALGR KC_RIGHT_ALT
+#define KC_RGUI KC_RIGHT_GUI
+#define KC_RCMD KC_RIGHT_GUI
+#define AU_ON QK_AUDIO_ON
+#define AU_OFF QK_AUDIO_OFF
+#define AU_TOGG QK_AUDIO_TOGGLE
+#define MU_ON QK_MUSIC_ON
+#define MU_OFF QK_MUSIC_OFF
+#define MU_TOGG QK_MUSIC_TOGGLE
+#define QK_RBT QK_REBOOT
+#define EE_CLR QK_CLEAR_EEPROM
+#define CW_TOGG QK_CAPS_WORD_TOGGLE
+
+/* Modifier bits (5-bit form: bit 4 selects the right-hand modifier) */
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+#define MOD_HYPR 0x0F
+#define MOD_MEH 0x07
+
+/* 8-bit modifier masks as returned by get_mods() */
+#define MOD_BIT(code) (1 << ((code) & 0x07))
+#define MOD_MASK_CTRL (MOD_BIT(KC_LEFT_CTRL) | MOD_BIT(KC_RIGHT_CTRL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LEFT_SHIFT) | MOD_BIT(KC_RIGHT_SHIFT))
+#define MOD_MASK_ALT (MOD_BIT(KC_LEFT_ALT) | MOD_BIT(KC_RIGHT_ALT))
+#define MOD_MASK_GUI (MOD_BIT(KC_LEFT_GUI) | MOD_BIT(KC_RIGHT_GUI))
+
+/* Modified keys */
+#define QK_LCTL 0x0100
+#define QK_LSFT 0x0200
+#define QK_LALT 0x0400
+#define QK_LGUI 0x0800
+#define QK_RMODS_MIN 0x1000
+#define QK_RCTL 0x1100
+#define QK_RSFT 0x1200
+#define QK_RALT 0x1400
+#define QK_RGUI 0x1800
+#define LCTL(kc) (QK_LCTL | (kc))
+#define LSFT(kc) (QK_LSFT | (kc))
+#define LALT(kc) (QK_LALT | (kc))
+#define LGUI(kc) (QK_LGUI | (kc))
+#define LOPT(kc) LALT(kc)
+#define LCMD(kc) LGUI(kc)
+#define RCTL(kc) (QK_RCTL | (kc))
+#define RSFT(kc) (QK_RSFT | (kc))
+#define RALT(kc) (QK_RALT | (kc))
+#define RGUI(kc) (QK_RGUI | (kc))
+#define ROPT(kc) RALT(kc)
+#define RCMD(kc) RGUI(kc)
+#define C(kc) LCTL(kc)
+#define S(kc) LSFT(kc)
+#define A(kc) LALT(kc)
+#define G(kc) LGUI(kc)
+#define HYPR(kc) (QK_LCTL | QK_LSFT | QK_LALT | QK_LGUI | (kc))
+#define MEH(kc) (QK_LCTL | QK_LSFT | QK_LALT | (kc))
+#define LCAG(kc) (QK_LCTL | QK_LALT | QK_LGUI | (kc))
+#define LSG(kc) (QK_LSFT | QK_LGUI | (kc))
+#define LAG(kc) (QK_LALT | QK_LGUI | (kc))
+#define LCA(kc) (QK_LCTL | QK_LALT | (kc))
+#define LSA(kc) (QK_LSFT | QK_LALT | (kc))
+#define LCS(kc) (QK_LCTL | QK_LSFT | (kc))
+#define RSG(kc) (QK_RSFT | QK_RGUI | (kc))
+#define RAG(kc) (QK_RALT | QK_RGUI | (kc))
+#define RCS(kc) (QK_RCTL | QK_RSFT | (kc))
+#define RSA(kc) (QK_RSFT | QK_RALT | (kc))
+
+/* Shifted symbols */
+#define KC_TILD LSFT(KC_GRAVE)
+#define KC_EXLM LSFT(KC_1)
+#define KC_AT LSFT(KC_2)
+#define KC_HASH LSFT(KC_3)
+#define KC_DLR LSFT(KC_4)
+#define KC_PERC LSFT(KC_5)
+#define KC_CIRC LSFT(KC_6)
+#define KC_AMPR LSFT(KC_7)
+#define KC_ASTR LSFT(KC_8)
+#define KC_LPRN LSFT(KC_9)
+#define KC_RPRN LSFT(KC_0)
+#define KC_UNDS LSFT(KC_MINUS)
+#define KC_PLUS LSFT(KC_EQUAL)
+#define KC_LCBR LSFT(KC_LEFT_BRACKET)
+#define KC_RCBR LSFT(KC_RIGHT_BRACKET)
+#define KC_PIPE LSFT(KC_BACKSLASH)
+#define KC_COLN LSFT(KC_SEMICOLON)
+#define KC_DQUO LSFT(KC_QUOTE)
+#define KC_DQT KC_DQUO
+#define KC_LABK LSFT(KC_COMMA)
+#define KC_LT KC_LABK
+#define KC_RABK LSFT(KC_DOT)
+#define KC_GT KC_RABK
+#define KC_QUES LSFT(KC_SLASH)
+
+/* Layer keys */
+#define TO(layer) (QK_TO | ((layer) & 0x1F))
+#define MO(layer) (QK_MOMENTARY | ((layer) & 0x1F))
+#define DF(layer) (QK_DEF_LAYER | ((layer) & 0x1F))
+#define PDF(layer) (QK_PERSISTENT_DEF_LAYER | ((layer) & 0x1F))
+#define TG(layer) (QK_TOGGLE_LAYER | ((layer) & 0x1F))
+#define OSL(layer) (QK_ONE_SHOT_LAYER | ((layer) & 0x1F))
+#define TT(layer) (QK_LAYER_TAP_TOGGLE | ((layer) & 0x1F))
+#define OSM(mod) (QK_ONE_SHOT_MOD | ((mod) & 0x1F))
+#define LM(layer, mod) (QK_LAYER_MOD | (((layer) & 0xF) << 5) | ((mod) & 0x1F))
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+#define TD(n) (QK_TAP_DANCE | ((n) & 0xFF))
+
+/* Mod-taps */
+#define MT(mod, kc) (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LCTL_T(kc) MT(MOD_LCTL, kc)
+#define LSFT_T(kc) MT(MOD_LSFT, kc)
+#define LALT_T(kc) MT(MOD_LALT, kc)
+#define LGUI_T(kc) MT(MOD_LGUI, kc)
+#define LOPT_T(kc) LALT_T(kc)
+#define LCMD_T(kc) LGUI_T(kc)
+#define RCTL_T(kc) MT(MOD_RCTL, kc)
+#define RSFT_T(kc) MT(MOD_RSFT, kc)
+#define RALT_T(kc) MT(MOD_RALT, kc)
+#define RGUI_T(kc) MT(MOD_RGUI, kc)
+#define ROPT_T(kc) RALT_T(kc)
+#define RCMD_T(kc) RGUI_T(kc)
+#define CTL_T(kc) LCTL_T(kc)
+#define SFT_T(kc) LSFT_T(kc)
+#define ALT_T(kc) LALT_T(kc)
+#define GUI_T(kc) LGUI_T(kc)
+#define HYPR_T(kc) MT(MOD_HYPR, kc)
+#define ALL_T(kc) HYPR_T(kc)
+#define MEH_T(kc) MT(MOD_MEH, kc)
+#define LCA_T(kc) MT(MOD_LCTL | MOD_LALT, kc)
+#define LCS_T(kc) MT(MOD_LCTL | MOD_LSFT, kc)
+#define LSA_T(kc) MT(MOD_LSFT | MOD_LALT, kc)
+#define LSG_T(kc) MT(MOD_LSFT | MOD_LGUI, kc)
+#define LAG_T(kc) MT(MOD_LALT | MOD_LGUI, kc)
+#define LCAG_T(kc) MT(MOD_LCTL | MOD_LALT | MOD_LGUI, kc)
+#define SGUI_T(kc) LSG_T(kc)
+#define C_S_T(kc) LCS_T(kc)
+
+/* Range tests and field extraction */
+#define IS_QK_MOD_TAP(code) ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code) ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define IS_QK_TAP_DANCE(code) ((code) >= QK_TAP_DANCE && (code) <= QK_TAP_DANCE_MAX)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_TAP_DANCE_GET_INDEX(kc) ((kc) & 0xFF)
@@ -0,0 +1,8 @@
+/*
+ * Stand-in for QMK's keymap_introspection.c: it compiles the keymap data in
+ * the same translation unit and checks the layer count against the layer
+ * state width, as QMK does at build time.
+ */
+#include "keymap_layers.c"
+
+_Static_assert(sizeof(keymaps) / sizeof(keymaps[0]) <= MAX_LAYER, "Number of keymap layers exceeds maximum set by LAYER_STATE_(8|16|32)BIT");
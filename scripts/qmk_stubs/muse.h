@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern uint8_t muse_offset;
+extern uint16_t muse_tempo;
+extern uint8_t  SCALE[];
+uint8_t muse_clock_pulse(void);
@@ -0,0 +1,299 @@
+#pragma once
+
+/*
+ * Minimal QMK/Vial declarations for oryx_to_olkb.py's pre-flight compile.
+ * Only what a converted keymap.c/keymap_layers.c, olkb_hooks.c and the
+ * modules built without MCU headers touch is declared, with QMK's types and
+ * hook signatures, so a host `cc -fsyntax-only` catches type and signature
+ * errors in seconds instead of at the end of `qmk compile`.
+ * Keycode values follow QMK but only need to be integer constants here.
+ * host_shim.c implements the functions for olkb_bench.py's host build.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+/* Planck Rev6 folded matrix */
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 6
+typedef uint8_t matrix_row_t;
+
+/* action_layer.h: the layer state width, 16-bit unless configured */
+#if defined(LAYER_STATE_8BIT)
+typedef uint8_t layer_state_t;
+#    define MAX_LAYER 8
+#elif defined(LAYER_STATE_32BIT)
+typedef uint32_t layer_state_t;
+#    define MAX_LAYER 32
+#else
+typedef uint16_t layer_state_t;
+#    define MAX_LAYER 16
+#endif
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+/* keyboard.h / action.h */
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum {
+    TICK_EVENT  = 0,
+    KEY_EVENT   = 1,
+    ENCODER_CW_EVENT,
+    ENCODER_CCW_EVENT,
+    COMBO_EVENT,
+    DIP_SWITCH_ON_EVENT,
+    DIP_SWITCH_OFF_EVENT,
+} keyevent_type_t;
+
+typedef struct {
+    keypos_t key;
+    uint16_t time;
+    uint8_t  type;
+    bool     pressed;
+} keyevent_t;
+
+static inline bool IS_EVENT(keyevent_t event) {
+    return event.type != TICK_EVENT;
+}
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;
+} keyrecord_t;
+
+typedef union {
+    uint8_t raw;
+    struct {
+        bool num_lock : 1;
+        bool caps_lock : 1;
+        bool scroll_lock : 1;
+        bool compose : 1;
+        bool kana : 1;
+    };
+} led_t;
+
+#define KEYEQ(a, b) ((a).row == (b).row && (a).col == (b).col)
+
+/* process_tap_dance.h */
+typedef struct {
+    uint16_t interrupting_keycode;
+    uint8_t  count;
+    uint8_t  weak_mods;
+    uint8_t  oneshot_mods;
+    bool     pressed : 1;
+    bool     finished : 1;
+    bool     interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+    tap_dance_state_t state;
+    struct {
+        tap_dance_user_fn_t on_each_tap;
+        tap_dance_user_fn_t on_dance_finished;
+        tap_dance_user_fn_t on_reset;
+        tap_dance_user_fn_t on_each_release;
+    } fn;
+    void *user_data;
+} tap_dance_action_t;
+
+typedef struct {
+    uint16_t kc1;
+    uint16_t kc2;
+} tap_dance_pair_t;
+
+#define ACTION_TAP_DANCE_DOUBLE(kc1, kc2) \
+    { .fn = {tap_dance_pair_on_each_tap, tap_dance_pair_finished, tap_dance_pair_reset, NULL}, .user_data = (void *)&((tap_dance_pair_t){kc1, kc2}) }
+#define ACTION_TAP_DANCE_FN(user_fn) \
+    { .fn = {NULL, user_fn, NULL, NULL}, .user_data = NULL }
+#define ACTION_TAP_DANCE_FN_ADVANCED(user_fn_on_each_tap, user_fn_on_dance_finished, user_fn_on_dance_reset) \
+    { .fn = {user_fn_on_each_tap, user_fn_on_dance_finished, user_fn_on_dance_reset, NULL}, .user_data = NULL }
+
+void tap_dance_pair_on_each_tap(tap_dance_state_t *state, void *user_data);
+void tap_dance_pair_finished(tap_dance_state_t *state, void *user_data);
+void tap_dance_pair_reset(tap_dance_state_t *state, void *user_data);
+void reset_tap_dance(tap_dance_state_t *state);
+uint16_t tap_dance_count(void);
+tap_dance_action_t *tap_dance_get(uint16_t tap_dance_idx);
+extern tap_dance_action_t tap_dance_actions[];
+
+#include "keycodes.h"
+
+/* User hooks, with the signatures QMK calls them through */
+void keyboard_pre_init_user(void);
+void keyboard_post_init_user(void);
+void matrix_init_user(void);
+void matrix_scan_user(void);
+void housekeeping_task_user(void);
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record);
+bool process_record_user(uint16_t keycode, keyrecord_t *record);
+void post_process_record_user(uint16_t keycode, keyrecord_t *record);
+layer_state_t layer_state_set_user(layer_state_t state);
+layer_state_t default_layer_state_set_user(layer_state_t state);
+bool led_update_user(led_t led_state);
+bool shutdown_user(bool jump_to_bootloader);
+void suspend_power_down_user(void);
+void suspend_wakeup_init_user(void);
+bool encoder_update_user(uint8_t index, bool clockwise);
+bool dip_switch_update_user(uint8_t index, bool active);
+bool music_mask_user(uint16_t keycode);
+void caps_word_set_user(bool active);
+bool caps_word_press_user(uint16_t keycode);
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t *record);
+bool get_permissive_hold(uint16_t keycode, keyrecord_t *record);
+bool get_hold_on_other_key_press(uint16_t keycode, keyrecord_t *record);
+bool get_retro_tapping(uint16_t keycode, keyrecord_t *record);
+char chordal_hold_handedness(keypos_t key);
+bool get_chordal_hold(uint16_t tap_hold_keycode, keyrecord_t *tap_hold_record, uint16_t other_keycode, keyrecord_t *other_record);
+uint16_t get_flow_tap_term(uint16_t keycode, keyrecord_t *record, uint16_t prev_keycode);
+
+#ifndef TAPPING_TERM
+#    define TAPPING_TERM 200
+#endif
+#ifdef TAPPING_TERM_PER_KEY
+#    define GET_TAPPING_TERM(keycode, record) get_tapping_term(keycode, record)
+#else
+#    define GET_TAPPING_TERM(keycode, record) TAPPING_TERM
+#endif
+
+/* Keycode actions */
+void register_code(uint8_t kc);
+void unregister_code(uint8_t kc);
+void tap_code(uint8_t kc);
+void tap_code_delay(uint8_t kc, uint16_t delay);
+void register_code16(uint16_t kc);
+void unregister_code16(uint16_t kc);
+void tap_code16(uint16_t kc);
+void tap_code16_delay(uint16_t kc, uint16_t delay);
+void send_keyboard_report(void);
+void clear_keyboard(void);
+
+/* Modifiers */
+uint8_t get_mods(void);
+void    set_mods(uint8_t mods);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    clear_mods(void);
+void    register_mods(uint8_t mods);
+void    unregister_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    clear_weak_mods(void);
+uint8_t get_oneshot_mods(void);
+void    set_oneshot_mods(uint8_t mods);
+void    add_oneshot_mods(uint8_t mods);
+void    del_oneshot_mods(uint8_t mods);
+void    clear_oneshot_mods(void);
+void    set_oneshot_layer(uint8_t layer, uint8_t state);
+void    clear_oneshot_layer_state(uint8_t state);
+
+/* Layers */
+void          layer_clear(void);
+void          layer_move(uint8_t layer);
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+void          layer_invert(uint8_t layer);
+bool          layer_state_is(uint8_t layer);
+bool          layer_state_cmp(layer_state_t state, uint8_t layer);
+uint8_t       get_highest_layer(layer_state_t state);
+void          layer_state_set(layer_state_t state);
+void          default_layer_set(layer_state_t state);
+void          set_single_persistent_default_layer(uint8_t default_layer);
+void          update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3);
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3);
+#define IS_LAYER_ON(layer) layer_state_is(layer)
+#define IS_LAYER_OFF(layer) (!layer_state_is(layer))
+#define IS_LAYER_ON_STATE(state, layer) layer_state_cmp(state, layer)
+
+/* Timers and waits */
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+void wait_ms(uint32_t ms);
+void wait_us(uint32_t us);
+
+/* send_string.h; SS_* macros stringify their X_ keycode, as QMK's do */
+void send_string(const char *string);
+void send_string_with_delay(const char *string, uint8_t interval);
+void send_char(char ascii_code);
+#define SEND_STRING(string) send_string(string)
+#define SEND_STRING_DELAY(string, interval) send_string_with_delay(string, interval)
+#define SS_TAP(keycode) "\1" #keycode
+#define SS_DOWN(keycode) "\2" #keycode
+#define SS_UP(keycode) "\3" #keycode
+#define SS_DELAY(msecs) "\4" #msecs "|"
+#define SS_LCTL(string) SS_DOWN(X_LCTL) string SS_UP(X_LCTL)
+#define SS_LSFT(string) SS_DOWN(X_LSFT) string SS_UP(X_LSFT)
+#define SS_LALT(string) SS_DOWN(X_LALT) string SS_UP(X_LALT)
+#define SS_LGUI(string) SS_DOWN(X_LGUI) string SS_UP(X_LGUI)
+#define SS_RCTL(string) SS_DOWN(X_RCTL) string SS_UP(X_RCTL)
+#define SS_RSFT(string) SS_DOWN(X_RSFT) string SS_UP(X_RSFT)
+#define SS_RALT(string) SS_DOWN(X_RALT) string SS_UP(X_RALT)
+#define SS_RGUI(string) SS_DOWN(X_RGUI) string SS_UP(X_RGUI)
+
+/* keymap_introspection.h / action_layer.h */
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+uint8_t  keymap_layer_count(void);
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+uint8_t  layer_switch_get_layer(keypos_t key);
+
+/* Miscellaneous */
+matrix_row_t matrix_get_row(uint8_t row);
+void         reset_keyboard(void);
+void         soft_reset_keyboard(void);
+void         eeconfig_init(void);
+void         raw_hid_send(uint8_t *data, uint8_t length);
+bool         is_caps_word_on(void);
+void         caps_word_on(void);
+void         caps_word_off(void);
+void         caps_word_toggle(void);
+
+/* Audio and music (AUDIO_ENABLE) */
+#define SONG(...) { __VA_ARGS__ }
+#define NO_SOUND
+#define PLANCK_SOUND {440.0f, 16}
+#define PLAY_SONG(note_array) audio_play_melody(&note_array, sizeof(note_array) / (sizeof(float) * 2), false)
+void  audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat);
+void  stop_all_notes(void);
+void  stop_note(float freq);
+void  play_note(float freq, int vol);
+float compute_freq_for_midi_note(uint8_t note);
+bool  is_audio_on(void);
+bool  is_music_on(void);
+void  music_on(void);
+void  music_off(void);
+
+/* Mouse keys (MOUSEKEY_ENABLE) */
+typedef struct {
+    uint8_t buttons;
+    int8_t  x;
+    int8_t  y;
+    int8_t  v;
+    int8_t  h;
+} report_mouse_t;
+report_mouse_t mousekey_get_report(void);
+void           host_mouse_send(report_mouse_t *report);
@@ -0,0 +1,70 @@
+/*
+ * Host test for olkb_modules/typing_speed.c: the tapping term it hands
+ * get_tapping_term() after a pause, during a burst and once idle again.
+ * Supplies its own millisecond clock, so no generated keymap is needed:
+ *
+ *   cc -std=gnu11 -Iscripts/qmk_stubs -Iscripts/olkb_modules \
+ *      scripts/qmk_stubs/typing_speed_test.c scripts/olkb_modules/typing_speed.c \
+ *      -o typing_speed_test && ./typing_speed_test
+ */
+#include "typing_speed.h"
+#include <stdio.h>
+
+static uint16_t clock_ms;
+static int      failures;
+
+uint16_t timer_read(void) {
+    return clock_ms;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(clock_ms, last);
+}
+
+static void press_at(uint16_t ms) {
+    clock_ms           = ms;
+    keyrecord_t record = {.event = {.key = {.row = 1, .col = 1}, .time = ms, .type = KEY_EVENT, .pressed = true}};
+    typing_speed_record(&record);
+}
+
+static void expect(const char *what, uint16_t got, uint16_t want) {
+    if (got != want) {
+        printf("FAIL %s: %u, expected %u\n", what, got, want);
+        failures++;
+    } else {
+        printf("ok   %s: %u\n", what, got);
+    }
+}
+
+int main(void) {
+    /* A key pressed long after the last one (an MT, say) must get the plain term */
+    press_at(10000);
+    expect("first press after a pause", typing_speed_tapping_term(TAPPING_TERM), TAPPING_TERM);
+    expect("average before any interval", typing_speed_average_ms(), 0);
+
+    /* The next press 80 ms later is the first real interval: the term shrinks */
+    press_at(10080);
+    expect("second press 80 ms later", typing_speed_tapping_term(TAPPING_TERM), 80 * TYPING_SPEED_TERM_FACTOR);
+    expect("burst after two fast presses", typing_speed_in_burst(), true);
+
+    /* A slow second press is a real interval too, and lengthens the term up to the cap */
+    press_at(20000);
+    press_at(20300);
+    expect("second press 300 ms later", typing_speed_tapping_term(TAPPING_TERM), TYPING_SPEED_MAX_TERM(TAPPING_TERM));
+
+    /* A per-key term twice the global one scales and clamps against itself, not TAPPING_TERM */
+    expect("300 ms, per-key term 2x", typing_speed_tapping_term(2 * TAPPING_TERM), TYPING_SPEED_MAX_TERM(2 * TAPPING_TERM));
+    press_at(20340);
+    press_at(20380);
+    press_at(20420);
+    press_at(20460);
+    /* Average 300 -> 235 -> 187 -> 151 -> 124 ms: twice the 248 ms the global term would give */
+    expect("average after four 40 ms presses", typing_speed_average_ms(), 124);
+    expect("burst, per-key term 2x", typing_speed_tapping_term(2 * TAPPING_TERM), 124 * TYPING_SPEED_TERM_FACTOR * 2);
+
+    /* Idle again: back to the plain term without a new press */
+    clock_ms = 20460 + TYPING_SPEED_IDLE_MS;
+    expect("idle", typing_speed_tapping_term(TAPPING_TERM), TAPPING_TERM);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+extern int vial_unlocked;